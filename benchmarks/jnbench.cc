@@ -0,0 +1,399 @@
+//-----------------------------------------------------------------------------
+// File: jnbench.cc
+// Purpose: Benchmarks of inference, training, testing and weight file I/O
+//          on synthetic data, written as JSON
+// Created: 18-Oct-2026
+//-----------------------------------------------------------------------------
+// Usage: jnbench [-o output.json] [-q] [-t threads] [-c]
+//
+//   -o  output file (default: bench.json)
+//   -q  quick run: smallest network and sample only
+//   -t  number of threads for training and testing (default: all cores)
+//   -c  check, instead, that methods 0, 1 and 2 give the weights of
+//       JETNET (JNTRAL) when trained natively; exit code 1 if not
+//
+// For each network shape and sample size, the benchmarks are
+//
+//   evaluate        Jetnet::evaluate, one pattern per call
+//   compiled        CompiledNetwork::evaluate, one pattern per call
+//   batch           CompiledNetwork::evaluate, the whole sample per call
+//   train           one train() epoch, for each method code, with
+//                   100 patterns per update
+//   train_default   the same for methods 0, 1 and 2, with the default
+//                   of 10 patterns per update
+//   test            test() on the testing sample
+//   save            save() of the weights (.jnw, .jetnet and .net)
+//   load_nnload     nnload() of the MLPfit file
+//   load_jnw        CompiledNetwork from the binary weight file
+//
+// Each timing is the best of several repetitions and is given per
+// item, which is a pattern, or a file for the I/O benchmarks.
+//-----------------------------------------------------------------------------
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <thread>
+#include <ctime>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+
+#include "Jetnet.h"
+#include "CompiledNetwork.h"
+#include "network.h"
+
+using namespace std;
+
+namespace {
+
+  struct Shape
+  {
+    int inputs;
+    int hidden;
+  };
+
+  struct Result
+  {
+    string name;
+    Shape  shape;
+    int    patterns;    // Sample size
+    int    method;      // -1 if not a training benchmark
+    string item;        // "pattern" or "file"
+    int    items;       // Items per repetition
+    double seconds;     // Best time of one repetition
+    int    repeats;
+  };
+
+  // JETNET method codes that can be chosen at initialization
+  const int METHODS[] = {0, 1, 2, 3, 4, 5, 6, 7, 10, 11, 12, 13, 15};
+  const int NMETHODS  = sizeof(METHODS) / sizeof(METHODS[0]);
+
+  double now()
+  {
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+  }
+
+  // Best time of repeats calls of f
+
+  template <class F>
+  double best(int repeats, F f)
+  {
+    double tbest = 0;
+    for (int r = 0; r < repeats; r++)
+      {
+	double t0 = now();
+	f();
+	double t = now() - t0;
+	if ( r == 0 || t < tbest ) tbest = t;
+      }
+    return tbest;
+  }
+
+  string variables(int n)
+  {
+    ostringstream os;
+    for (int i = 0; i < n; i++) os << (i > 0 ? " " : "") << "x" << i;
+    return os.str();
+  }
+
+  // Half signal, half background; the signal is shifted in every input
+
+  void synthesize(int inputs, int n, unsigned seed,
+		  vector<float>& data, vector<float>& target)
+  {
+    mt19937 engine(seed);
+    normal_distribution<float> gauss(0, 1);
+    data.resize((size_t)n * inputs);
+    target.resize(n);
+    for (int p = 0; p < n; p++)
+      {
+	target[p] = p % 2;
+	for (int j = 0; j < inputs; j++)
+	  data[(size_t)p * inputs + j] = gauss(engine) + 0.5f * target[p];
+      }
+  }
+
+  Jetnet* network(Shape s, int n, int method, int nthreads,
+		  const vector<float>& data, const vector<float>& target,
+		  int patternsPerUpdate=100)
+  {
+    Jetnet* nn = new Jetnet(variables(s.inputs), s.hidden);
+    nn->setThreads(nthreads);
+    nn->loadPatterns(data.data(), n, s.inputs, s.inputs, target.data(),
+		     Jetnet::kTRAINING);
+    nn->loadPatterns(data.data(), n, s.inputs, s.inputs, target.data(),
+		     Jetnet::kTESTING);
+    nn->setMethod(method);
+    nn->setParameter("patternsPerUpdate", patternsPerUpdate);
+    nn->setEta(0.01);
+    // Repeated epochs of the line-search methods can exceed the
+    // default number of restarts, which stops the program
+    nn->setParameter("maximumRestarts", 1000000);
+    nn->begin();
+    return nn;
+  }
+
+  // Largest difference between the weights of methods 0, 1 and 2
+  // trained natively and by JETNET, relative to the largest weight.
+  // With one update per epoch, the two differ only in the rounding of
+  // the sums over the patterns.
+
+  bool check(int nthreads)
+  {
+    const Shape  s         = {5, 10};
+    const int    n         = 1000;
+    const int    EPOCHS    = 5;
+    const double TOLERANCE = 1e-4;
+    vector<float> data, target;
+    synthesize(s.inputs, n, 54321, data, target);
+
+    bool ok = true;
+    for (int method = 0; method <= 2; method++)
+      {
+	vector<float> weight[2];
+	for (int k = 0; k < 2; k++)
+	  {
+	    Jetnet* nn = network(s, n, method, nthreads, data, target, n);
+	    nn->setNativeTraining(k == 0);
+	    nn->setEta(0.5);
+	    for (int e = 0; e < EPOCHS; e++) nn->train();
+	    CompiledNetwork f = nn->compile();
+	    weight[k] = f.weights();
+	    delete nn;
+	  }
+	double dmax = 0, wmax = 0;
+	for (size_t i = 0; i < weight[0].size(); i++)
+	  {
+	    dmax = max(dmax, (double)fabs(weight[0][i] - weight[1][i]));
+	    wmax = max(wmax, (double)fabs(weight[1][i]));
+	  }
+	double d = wmax > 0 ? dmax / wmax : dmax;
+	bool good = d <= TOLERANCE;
+	cerr << "jnbench: method " << method << "  native vs JNTRAL  "
+	     << setprecision(3) << d << (good ? "  ok" : "  FAILED") << endl;
+	ok = ok && good;
+      }
+    return ok;
+  }
+
+  string timestamp()
+  {
+    time_t t = time(0);
+    char buf[32];
+    strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%SZ", gmtime(&t));
+    return buf;
+  }
+
+  void write(ostream& out, const vector<Result>& results, int nthreads)
+  {
+    out << "{" << endl;
+    out << "  \"suite\": \"jnbench\"," << endl;
+    out << "  \"schema\": 1," << endl;
+    out << "  \"date\": \"" << timestamp() << "\"," << endl;
+    out << "  \"compiler\": \"" << __VERSION__ << "\"," << endl;
+    out << "  \"hardware_threads\": "
+	<< thread::hardware_concurrency() << "," << endl;
+    out << "  \"threads\": " << nthreads << "," << endl;
+    out << "  \"results\": [" << endl;
+    for (size_t i = 0; i < results.size(); i++)
+      {
+	const Result& r = results[i];
+	out << "    {\"name\": \"" << r.name << "\""
+	    << ", \"inputs\": " << r.shape.inputs
+	    << ", \"hidden\": " << r.shape.hidden
+	    << ", \"patterns\": " << r.patterns;
+	if ( r.method >= 0 ) out << ", \"method\": " << r.method;
+	out << ", \"item\": \"" << r.item << "\""
+	    << ", \"items\": " << r.items
+	    << setprecision(6)
+	    << ", \"seconds\": " << r.seconds
+	    << ", \"ns_per_item\": " << 1e9 * r.seconds / r.items
+	    << ", \"items_per_second\": " << r.items / r.seconds
+	    << ", \"repeats\": " << r.repeats
+	    << "}" << (i + 1 < results.size() ? "," : "") << endl;
+      }
+    out << "  ]" << endl;
+    out << "}" << endl;
+  }
+};
+
+int main(int argc, char** argv)
+{
+  string output("bench.json");
+  bool   quick    = false;
+  bool   checking = false;
+  int    nthreads = thread::hardware_concurrency();
+  for (int i = 1; i < argc; i++)
+    {
+      if      ( strcmp(argv[i], "-o") == 0 && i + 1 < argc )
+	output = argv[++i];
+      else if ( strcmp(argv[i], "-t") == 0 && i + 1 < argc )
+	nthreads = atoi(argv[++i]);
+      else if ( strcmp(argv[i], "-q") == 0 )
+	quick = true;
+      else if ( strcmp(argv[i], "-c") == 0 )
+	checking = true;
+      else
+	{
+	  cout << "Usage: jnbench [-o output.json] [-q] [-t threads] [-c]"
+	       << endl;
+	  return 1;
+	}
+    }
+  if ( nthreads < 1 ) nthreads = 1;
+  if ( checking ) return check(nthreads) ? 0 : 1;
+
+  vector<Shape> shapes;
+  shapes.push_back(Shape{5,  10});
+  shapes.push_back(Shape{20, 40});
+  shapes.push_back(Shape{50, 100});
+  vector<int> sizes;
+  sizes.push_back(10000);
+  sizes.push_back(100000);
+  if ( quick )
+    {
+      shapes.resize(1);
+      sizes.resize(1);
+    }
+
+  const int REPEATS = quick ? 2 : 5;
+  string    stem("jnbench_tmp");
+  vector<Result> results;
+  auto record = [&](string name, Shape s, int n, int method,
+		    string item, int items, double seconds, int repeats)
+    {
+      Result r = {name, s, n, method, item, items, seconds, repeats};
+      results.push_back(r);
+      cerr << "jnbench: " << setw(14) << left << name << right
+	   << setw(4) << s.inputs << "-" << setw(3) << left << s.hidden
+	   << right << setw(8) << n;
+      if ( method >= 0 ) cerr << "  method " << setw(2) << method;
+      cerr << "  " << setprecision(4) << 1e9 * seconds / items 
+	   << " ns/" << item << endl;
+    };
+
+  for (size_t is = 0; is < shapes.size(); is++)
+    for (size_t in = 0; in < sizes.size(); in++)
+      {
+	Shape s = shapes[is];
+	int   n = sizes[in];
+	vector<float> data, target;
+	synthesize(s.inputs, n, 12345 + n + s.inputs, data, target);
+
+	// Inference and testing, with a network trained for one epoch
+
+	Jetnet* nn = network(s, n, 0, nthreads, data, target);
+	nn->train();
+
+	vector<float> inp(s.inputs);
+	volatile float sink = 0;
+	double t = best(REPEATS, [&]()
+	  {
+	    for (int p = 0; p < n; p++)
+	      {
+		copy(&data[(size_t)p * s.inputs],
+		     &data[(size_t)(p + 1) * s.inputs], inp.begin());
+		sink = sink + nn->evaluate(inp);
+	      }
+	  });
+	record("evaluate", s, n, -1, "pattern", n, t, REPEATS);
+
+	nn->save(stem, false);
+	CompiledNetwork f(stem + ".jnw");
+	t = best(REPEATS, [&]()
+	  {
+	    for (int p = 0; p < n; p++)
+	      sink = sink + f.evaluate(&data[(size_t)p * s.inputs]);
+	  });
+	record("compiled", s, n, -1, "pattern", n, t, REPEATS);
+
+	vector<float> out(n);
+	t = best(REPEATS, [&]()
+	  {
+	    f.evaluate(data.data(), n, s.inputs, out.data());
+	  });
+	record("batch", s, n, -1, "pattern", n, t, REPEATS);
+
+	t = best(REPEATS, [&]() { nn->test(Jetnet::kTESTING); });
+	record("test", s, n, -1, "pattern", n, t, REPEATS);
+
+	// Weight files
+
+	const int NFILES = 20;
+	t = best(REPEATS, [&]()
+	  {
+	    for (int k = 0; k < NFILES; k++) nn->save(stem, false);
+	  });
+	record("save", s, n, -1, "file", NFILES, t, REPEATS);
+
+	t = best(REPEATS, [&]()
+	  {
+	    for (int k = 0; k < NFILES; k++)
+	      {
+		vector<int> nodes;
+		vector<double> weight;
+		vector<string> var;
+		vector<float> mean, sigma;
+		int outputType;
+		nnload(stem + ".net", nodes, weight, var, mean, sigma,
+		       outputType);
+	      }
+	  });
+	record("load_nnload", s, n, -1, "file", NFILES, t, REPEATS);
+
+	t = best(REPEATS, [&]()
+	  {
+	    for (int k = 0; k < NFILES; k++)
+	      {
+		CompiledNetwork g(stem + ".jnw");
+		sink = sink + g.evaluate(data.data());
+	      }
+	  });
+	record("load_jnw", s, n, -1, "file", NFILES, t, REPEATS);
+	delete nn;
+
+	// One training epoch per method. The first epoch is not timed.
+
+	for (int m = 0; m < NMETHODS; m++)
+	  {
+	    Jetnet* nm = network(s, n, METHODS[m], nthreads, data, target);
+	    nm->train();
+	    int repeats = max(REPEATS / 2, 1);
+	    t = best(repeats, [&]() { nm->train(); });
+	    record("train", s, n, METHODS[m], "pattern", n, t, repeats);
+	    delete nm;
+	  }
+
+	// Methods 0, 1 and 2 at the default number of patterns per update
+
+	for (int method = 0; method <= 2; method++)
+	  {
+	    Jetnet* nm = network(s, n, method, nthreads, data, target, 10);
+	    nm->train();
+	    int repeats = max(REPEATS / 2, 1);
+	    t = best(repeats, [&]() { nm->train(); });
+	    record("train_default", s, n, method, "pattern", n, t, repeats);
+	    delete nm;
+	  }
+      }
+
+  const char* ext[] = {".jnw", ".jetnet", ".net"};
+  for (int k = 0; k < 3; k++) remove((stem + ext[k]).c_str());
+
+  ofstream out(output.c_str());
+  if ( !out )
+    {
+      cout << "jnbench: unable to open " << output << endl;
+      return 1;
+    }
+  write(out, results, nthreads);
+  cerr << "jnbench: results written to " << output << endl;
+  return 0;
+}
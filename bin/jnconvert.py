@@ -0,0 +1,32 @@
+#!/usr/bin/env python
+#------------------------------------------------------------------------------
+# File: jnconvert.py
+# Description: Convert text tables (header line followed by rows of numbers)
+#              to the binary columnar format read by Jetnet::loadFile
+#------------------------------------------------------------------------------
+import os, sys
+from ROOT import gSystem
+#------------------------------------------------------------------------------
+argv = sys.argv[1:]
+argc = len(argv)
+if argc < 1:
+    print "Usage:\n\tjnconvert.py <textfile> [<textfile>...]"
+    print "\tWrites <textfile>.jnd (with the extension of <textfile> replaced)"
+    sys.exit(0)
+
+gSystem.AddDynamicPath("$JETNET_PATH/lib")
+if gSystem.Load('libjetnet') < 0:
+    sys.exit("** unable to load libjetnet")
+from ROOT import DataFile
+
+errors = {-1: "can't open file", -2: "row with wrong number of values"}
+
+for inpfile in argv:
+    if not os.path.exists(inpfile):
+        print "Can't find %s" % inpfile
+        sys.exit(0)
+    outfile = os.path.splitext(inpfile)[0] + ".jnd"
+    print "%s -> %s" % (inpfile, outfile)
+    status = DataFile.convert(inpfile, outfile)
+    if status != 0:
+        sys.exit("** error converting %s: %s" % (inpfile, errors[status]))
@@ -0,0 +1,39 @@
+#!/usr/bin/env python
+#------------------------------------------------------------------------------
+# File: jnweights.py
+# Description: Convert network weight files between the JETNET (.jetnet),
+#              MLPfit (.net) and binary (.jnw) formats
+#------------------------------------------------------------------------------
+import os, sys
+from ROOT import gSystem
+#------------------------------------------------------------------------------
+argv = sys.argv[1:]
+argc = len(argv)
+if argc < 1:
+    print "Usage:\n\tjnweights.py <weightfile> [<weightfile>...]"
+    print "\t<name>.net    -> <name>.jnw"
+    print "\t<name>.jetnet -> <name>.jnw (reads <name>.jetnet and <name>.net)"
+    print "\t<name>.jnw    -> <name>.jetnet and <name>.net"
+    sys.exit(0)
+
+gSystem.AddDynamicPath("$JETNET_PATH/lib")
+if gSystem.Load('libjetnet') < 0:
+    sys.exit("** unable to load libjetnet")
+from ROOT import WeightFile, Jetnet
+
+for inpfile in argv:
+    if not os.path.exists(inpfile):
+        print "Can't find %s" % inpfile
+        sys.exit(0)
+    name, ext = os.path.splitext(inpfile)
+    if ext == ".net":
+        print "%s -> %s.jnw" % (inpfile, name)
+        if WeightFile.convert(inpfile, name + ".jnw") != 0:
+            sys.exit("** error converting %s" % inpfile)
+    elif ext in [".jetnet", ".jnw"]:
+        # Jetnet::save writes all three formats
+        print "%s -> %s.{jetnet,net,jnw}" % (inpfile, name)
+        nn = Jetnet(inpfile)
+        nn.save(name, False)
+    else:
+        sys.exit("** unknown weight file extension %s" % ext)
@@ -9,6 +9,7 @@
 #              16-Jun-2016 HBP add more comments
 #-----------------------------------------------------------------------------
 import sys, os
+import numpy
 from string import *
 from ROOT import *
 #-----------------------------------------------------------------------------
@@ -33,8 +34,9 @@ def readData(filename):
     print "reading data from %s..." % filename
     records = map(split, open(filename).readlines())
     header  = records[0]
-    # convert to floating point numbers
-    records = map(lambda x: map(atof, x), records[1:])
+    # convert to a contiguous array of floating point numbers
+    records = numpy.array(map(lambda x: map(atof, x), records[1:]),
+                          dtype=numpy.float32)
     
     varmap  = {}
     for index, name in enumerate(header):
@@ -63,27 +65,19 @@ def loadNetwork(title,
 
     nrows = min(nrows, min(len(sig), len(bkg)))
 
-    # Set either test or training sample
-    nn.setSample(sample)
-
-    # inputs are a C++ vector of doubles
-    inpvar = vector('double')(len(variables))
-
-    # load signals
-    target = 1
-    for record in sig[:nrows]:
-        for i, var in enumerate(variables):
-            inpvar[i] = record[varmap[var]]
-            
-        nn.setPattern(inpvar, target)
-
-    # load backgrounds
-    target = 0
-    for record in bkg[:nrows]:
-        for i, var in enumerate(variables):
-            inpvar[i] = record[varmap[var]]
-            
-        nn.setPattern(inpvar, target)
+    # column index of each network input
+    columns = vector('int')()
+    for var in variables:
+        columns.push_back(varmap[var])
+
+    # load signals (target = 1) and backgrounds (target = 0), one call
+    # per array; the numpy buffers are read directly by Jetnet
+    for records, target in [(sig, 1), (bkg, 0)]:
+        data    = records[:nrows]
+        targets = numpy.full(len(data), target, dtype=numpy.float32)
+        ncols   = data.shape[1]
+        nn.loadPatterns(data, len(data), ncols, ncols, targets,
+                        sample, columns)
 #-----------------------------------------------------------------------------
 class Plot:
 
@@ -202,15 +196,6 @@ def main():
 
     plot = Plot(netname, nepoch, NBIN)
 
-    #-----------------------------------------------------------------------
-    # Get data
-    #-----------------------------------------------------------------------
-    varmap, sig = readData(sigfile)
-    varmap, bkg = readData(bkgfile)
-
-    ntrain = min( min(len(sig), len(bkg)) / 2 , ntrain)
-    ntest  = ntrain
-    print "Number of training events/file %s\n" % ntrain 
     #-----------------------------------------------------------------------
     # Define network
     #-----------------------------------------------------------------------
@@ -218,21 +203,48 @@ def main():
     
     nn = Jetnet(varlist, nhidden)
 
-    loadNetwork("load training data",
-            varmap,
-            sig,
-            bkg,
-            varlist,
-            ntrain,
-            Jetnet.kTRAINING, nn)
-
-    loadNetwork("load test data",
-            varmap,
-            sig[ntrain:],
-            bkg[ntrain:],
-            varlist,
-            ntest,
-            Jetnet.kTESTING, nn)
+    #-----------------------------------------------------------------------
+    # Get data. Use the binary versions of the tables (made with
+    # jnconvert.py) if they exist, since they need no parsing
+    #-----------------------------------------------------------------------
+    sigbin = os.path.splitext(sigfile)[0] + ".jnd"
+    bkgbin = os.path.splitext(bkgfile)[0] + ".jnd"
+
+    if os.path.exists(sigbin) and os.path.exists(bkgbin):
+        nsig = DataFile(sigbin).rows()
+        nbkg = DataFile(bkgbin).rows()
+        ntrain = min( min(nsig, nbkg) / 2 , ntrain)
+        ntest  = ntrain
+        print "Number of training events/file %s\n" % ntrain 
+
+        for first, sample in [(0, Jetnet.kTRAINING), (ntrain, Jetnet.kTESTING)]:
+            if not nn.loadFile(sigbin, 1, sample, first, ntrain):
+                error("unable to load %s" % sigbin)
+            if not nn.loadFile(bkgbin, 0, sample, first, ntrain):
+                error("unable to load %s" % bkgbin)
+    else:
+        varmap, sig = readData(sigfile)
+        varmap, bkg = readData(bkgfile)
+
+        ntrain = min( min(len(sig), len(bkg)) / 2 , ntrain)
+        ntest  = ntrain
+        print "Number of training events/file %s\n" % ntrain 
+
+        loadNetwork("load training data",
+                varmap,
+                sig,
+                bkg,
+                varlist,
+                ntrain,
+                Jetnet.kTRAINING, nn)
+
+        loadNetwork("load test data",
+                varmap,
+                sig[ntrain:],
+                bkg[ntrain:],
+                varlist,
+                ntest,
+                Jetnet.kTESTING, nn)
 
     #-----------------------------------------------------------------------
     # Train!
@@ -261,13 +273,15 @@ def main():
                 plot.hist(nn)        
                 plot.series(epoch, rms0, rms1)
                 
-                # save weights to .jetnet
-                nn.save()
+            # keep weights in memory if among the best so far
+            nn.snapshot(rms1)
     plot.save()
 
     #-----------------------------------------------------------------------
-    # Save weights and network function
+    # Save weights and network function of the best network
     #-----------------------------------------------------------------------
+    if nn.restore():
+        print "best RMS(test) %10.4f" % nn.snapshotRMS()
     nn.save(netname)
     os.system("rm -rf *.net")
 #---------------------------------------------------------------------------
@@ -0,0 +1,76 @@
+#ifndef ACTIVATIONTABLE_H
+#define ACTIVATIONTABLE_H
+//-----------------------------------------------------------------------------
+// File: ActivationTable.h
+// Purpose: Shared interpolation table of tanh for low-latency scoring
+// Created: 18-Oct-2026
+//-----------------------------------------------------------------------------
+#include <vector>
+
+/** Table of tanh on [-8, 8], linearly interpolated, for computing the
+    transfer functions of a network (tanh for the hidden nodes, and
+    1/(1+exp(-2x)) = (1+tanh(x))/2 for a sigmoid output) without
+    evaluating a rational function or an exponential per node.
+    <p>
+    Tables are created on first request and shared by the whole
+    process: there is one table per resolution, whatever the number of
+    networks that use it, and it is never freed. A table is immutable
+    and can be used by any number of threads. The resolution is a
+    power of two; 4096 intervals (16 kB, error 1.5e-6) suit the small
+    networks for which the transfer functions dominate the cost.
+*/
+class ActivationTable
+{
+ public:
+
+  /// Half-width of the tabulated range; beyond it tanh is +/-1.
+  static const int RANGE = 8;
+
+  /** Return the shared table with the given number of intervals,
+      rounded up to a power of two between 64 and 65536.
+  */
+  static const ActivationTable* shared(int intervals);
+
+  /** Return the coarsest shared table whose largest absolute error
+      on tanh is below maxError (at least 1e-6).
+  */
+  static const ActivationTable* forError(double maxError);
+
+  /// Number of intervals needed for the given largest error.
+  static int intervalsFor(double maxError);
+
+  /// Interpolated tanh(x).
+  float  tanh(float x) const
+  {
+    float u = (x + RANGE) * _scale;
+    u = u < 0 ? 0 : (u > _top ? _top : u);
+    int   k = (int)u;
+    k = k < _intervals ? k : _intervals - 1;
+    return _value[k] + (u - k) * (_value[k+1] - _value[k]);
+  }
+
+  /** Apply transfer function (code as in nnkernel.h) to n contiguous
+      values, in place.
+  */
+  void   apply(int type, float* x, int n) const;
+
+  /// Number of intervals.
+  int    intervals() const { return _intervals; }
+
+  /// Largest absolute error on tanh, measured when the table is built.
+  double maxError() const { return _maxError; }
+
+  /// The intervals()+1 values of tanh at the ends of the intervals.
+  const float* values() const { return _value.data(); }
+
+ private:
+  ActivationTable(int intervals);
+
+  int    _intervals;
+  float  _scale;        // Intervals per unit of x
+  float  _top;          // Largest position, as a float
+  double _maxError;
+  std::vector<float> _value;
+};
+
+#endif
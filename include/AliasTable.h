@@ -0,0 +1,49 @@
+#ifndef ALIASTABLE_H
+#define ALIASTABLE_H
+//-----------------------------------------------------------------------------
+// File: AliasTable.h
+// Purpose: Walker's alias table for drawing indices in proportion to weights
+// Created: 18-Oct-2026
+//-----------------------------------------------------------------------------
+#include <vector>
+#include <cstddef>
+
+/** Alias table (Walker's method, as built by Vose) for drawing the
+    indices 0,...,n-1 with probabilities proportional to given weights.
+    Building the table takes O(n) time; each draw then takes O(1) time,
+    a uniform random column and a uniform random number, whatever the
+    distribution of the weights. Negative weights are treated as zero.
+*/
+class AliasTable
+{
+ public:
+
+  ///
+  AliasTable() {}
+
+  /// Build table for n weights; return false if no weight is positive.
+  bool   build(const float* weights, size_t n);
+
+  /// Number of indices.
+  size_t size() const { return _prob.size(); }
+
+  /** Draw an index.
+      @param column - Uniform random integer in [0, size()), selects a
+                      column; it must be drawn as an integer (e.g. by
+                      Permutation::below), since a float in [0, 1)
+                      cannot reach every column of a large table
+      @param u2     - Uniform random number in [0, 1), selects the
+                      column index or its alias
+  */
+  int    draw(size_t column, float u2) const
+  {
+    size_t k = column < _prob.size() ? column : _prob.size() - 1;
+    return u2 < _prob[k] ? (int)k : _alias[k];
+  }
+
+ private:
+  std::vector<float> _prob;   // Probability of keeping column index
+  std::vector<int>   _alias;  // Index drawn otherwise
+};
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef BACKPROP_H
+#define BACKPROP_H
+//-----------------------------------------------------------------------------
+// File: BackProp.h
+// Purpose: Native back-propagation engine for JETNET methods 0, 1 and 2
+// Created: 18-Oct-2026
+//-----------------------------------------------------------------------------
+#include <vector>
+
+class PatternStore;
+class NetworkState;
+class JetnetContext;
+class TrainingStats;
+namespace jtn { class ThreadPool; };
+
+/** Native replacement for repeated calls of JNTRAL.
+    The engine trains a network held in a NetworkState, using 
+    standard back-propagation (method 0), Manhattan (1) or Langevin
+    (2) updating, with the same update rules as JNTRAL:
+    learning rate (PARJN(1), ETAL), momentum (PARJN(2)), inverse
+    temperature (PARJN(3), TINV), weight decay (PARJN(5)), noise
+    (PARJN(6)), pruning (MSTJN(21)) and the end-of-epoch parameter
+    changes. The training parameters are read from, and updated in,
+    a JetnetContext rather than the JETNET common blocks, and the
+    weights are held in a NetworkState, so the engine handles
+    networks too large for the common blocks and several networks can
+    be trained at the same time by different engines.
+    <p>
+    Each update of MSTJN(2) patterns is split into one slice per
+    thread (of at most NNBLOCK patterns, and at least a few), whose
+    forward and backward passes run in parallel. The gradients of the
+    slices are summed in slice order, so the results depend on the
+    number of threads only through the rounding of these sums. An
+    update with too little work for the threads to pay off runs on
+    the calling thread, with the same results.
+    <p>
+    If the patterns are weighted, the error and the gradient of each
+    pattern are multiplied by its weight (times a common scale).
+*/
+class BackProp
+{
+ public:
+
+  ///
+  BackProp();
+
+  /// True if the JETNET settings of jn can be handled natively.
+  static bool supported(const JetnetContext& jn);
+
+  /** Train on all patterns of input, in order.
+      @param jn    - Switches, parameters and training state
+      @param net   - Network to be trained
+      @param input - Patterns and targets
+      @param mean  - Mean of each input (empty if the inputs of input
+                     are already normalized)
+      @param sigma - Scale of each input (empty if normalized)
+      @param pool  - Threads used for the slices
+      @param wscale - Scale of the pattern weights (0 ignores them)
+      @param rows  - Patterns to train on, in order, if not all of input
+      @param stats - Counters and timers to add to (optional)
+  */
+  void train(JetnetContext& jn,
+	     NetworkState& net,
+	     const PatternStore& input,
+	     const std::vector<float>& mean,
+	     const std::vector<float>& sigma,
+	     jtn::ThreadPool* pool,
+	     float wscale=1,
+	     const std::vector<int>* rows=0,
+	     TrainingStats* stats=0);
+
+ private:
+  JetnetContext* _jn;
+  NetworkState*  _net;
+  float          _wscale;
+  const std::vector<int>* _rows;
+
+  // Offset of the nodes of each layer in the scratch space of a thread
+  std::vector<int> _off;
+  int  _worksize;
+
+  // Scratch space: per thread and per slice
+  std::vector<std::vector<float> > _work;
+  std::vector<std::vector<float> > _grad;
+  std::vector<float> _err;
+
+  // Forward and backward time of each slice
+  std::vector<double> _time;
+
+  void _slice(const PatternStore& input, size_t first, int n,
+	      const std::vector<float>& mean,
+	      const std::vector<float>& sigma,
+	      float* work, float* grad, float* err, double* time);
+  size_t _row(size_t i) const { return _rows ? (*_rows)[i] : i; }
+  void _update();
+  void _epoch();
+
+  float _beta(int l) const;
+  float _eta(int l) const;
+};
+
+#endif
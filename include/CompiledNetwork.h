@@ -0,0 +1,130 @@
+#ifndef COMPILEDNETWORK_H
+#define COMPILEDNETWORK_H
+//-----------------------------------------------------------------------------
+// File: CompiledNetwork.h
+// Purpose: Immutable, self-contained network function
+// Created: 18-Oct-2026
+//-----------------------------------------------------------------------------
+#include <string>
+#include <vector>
+#include <cstddef>
+
+class ActivationTable;
+
+/** Immutable feed-forward network function.
+    A CompiledNetwork holds its own copy of the network structure,
+    weights and input scaling (the data read by nnload) and uses none
+    of the JETNET common blocks. It is never modified after
+    construction, so a single instance can be shared by any number
+    of threads without locking. Scratch space is allocated per call
+    (single patterns) or per thread (batches).
+*/
+class CompiledNetwork
+{
+ public:
+
+  ///
+  CompiledNetwork();
+
+  /** Build network function.
+      @param nodes      - Number of nodes per layer
+      @param weight     - Weights in MLPfit ordering
+      @param mean       - Mean of each input variable
+      @param sigma      - Scale of each input variable
+      @param outputType - 0 for sigmoid output, 1 for linear output
+  */
+  CompiledNetwork(const std::vector<int>&    nodes,
+		  const std::vector<double>& weight,
+		  const std::vector<float>&  mean,
+		  const std::vector<float>&  sigma,
+		  int outputType);
+
+  /** Build network function from a weight file, either a binary
+      weight file (see WeightFile) or an MLPfit formatted file.
+      @param filename - Weight file (extension .jnw or .net)
+   */
+  CompiledNetwork(std::string filename);
+
+  ///
+  ~CompiledNetwork();
+
+  /// Compute network output for a single pattern.
+  float evaluate(const float* inp) const;
+
+  ///
+  float evaluate(const double* inp) const;
+
+  ///
+  float evaluate(const std::vector<float>& inp) const;
+
+  ///
+  float evaluate(const std::vector<double>& inp) const;
+
+  /** Compute network output for a batch of patterns.
+      @param rows   - First input value of first pattern
+      @param n      - Number of patterns
+      @param stride - Distance (in floats) between successive patterns
+      @param out    - Array of at least n network outputs
+  */
+  void  evaluate(const float* rows, size_t n, size_t stride,
+		 float* out) const;
+
+  /** Same as above, for patterns whose inputs have already been
+      normalized, (x - mean) / sigma.
+  */
+  void  evaluateNormalized(const float* rows, size_t n, size_t stride,
+			   float* out) const;
+
+  /// Number of inputs.
+  int   inputs() const { return _nodes.size() > 0 ? _nodes[0] : 0; }
+
+  /// Number of nodes per layer.
+  const std::vector<int>& nodes() const { return _nodes; }
+
+  /// Weights in MLPfit ordering, with the inverse temperatures
+  /// folded in.
+  const std::vector<float>& weights() const { return _weight; }
+
+  /// Mean of each input variable.
+  const std::vector<float>& mean() const { return _mean; }
+
+  /// Scale of each input variable.
+  const std::vector<float>& sigma() const { return _sigma; }
+
+  /// 0 for sigmoid output, 1 for linear output.
+  int   outputType() const 
+  { return _types.size() > 0 && _types.back() == 4 ? 1 : 0; }
+
+  /// False if the network has no weights.
+  bool  good() const { return _weight.size() > 0; }
+
+  /** Return a copy that computes the transfer functions by
+      interpolation in a shared table (see ActivationTable), or
+      exactly if table is zero.
+  */
+  CompiledNetwork tabulated(const ActivationTable* table) const;
+
+  /// Table of transfer functions, or zero if they are computed exactly.
+  const ActivationTable* table() const { return _table; }
+
+ private:
+  std::vector<int>   _nodes;
+  std::vector<float> _weight;
+  std::vector<int>   _types;
+  std::vector<float> _mean;
+  std::vector<float> _sigma;
+  int                _maxnodes;
+  const ActivationTable* _table;
+
+  void _build(const std::vector<int>&    nodes,
+	      const std::vector<double>& weight,
+	      const std::vector<float>&  mean,
+	      const std::vector<float>&  sigma,
+	      int outputType);
+
+  template <class T> float _evaluate(const T* inp) const;
+  void _batch(const float* rows, size_t n, size_t stride, float* out,
+	      bool normalized) const;
+};
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef DATAFILE_H
+#define DATAFILE_H
+//-----------------------------------------------------------------------------
+// File: DataFile.h
+// Purpose: Memory-mapped binary columnar data files
+// Created: 18-Oct-2026
+//-----------------------------------------------------------------------------
+#include <string>
+#include <vector>
+#include <cstddef>
+
+/** Read-only, memory-mapped binary columnar data file.
+    The file is mapped into memory, not read, so that repeated runs
+    and concurrent processes share the operating system's page cache
+    and no parsing is needed.
+    <p>
+    File layout (all numbers in native byte order):
+    <table>
+    <tr align=left><td>char[8]</td> <td>magic "JNDATA\\0\\0"</td></tr>
+    <tr align=left><td>uint32</td>  <td>format version (1)</td></tr>
+    <tr align=left><td>uint32</td>  <td>number of columns</td></tr>
+    <tr align=left><td>uint64</td>  <td>number of rows</td></tr>
+    <tr align=left><td>uint64</td>  <td>offset of first column</td></tr>
+    <tr align=left><td>uint64</td>  <td>distance between columns (bytes)</td></tr>
+    <tr align=left><td></td>  <td>for each column: uint32 length of
+                                  name, followed by the name</td></tr>
+    <tr align=left><td></td>  <td>columns of float32 values, each
+                                  starting on a 64-byte boundary</td></tr>
+    </table>
+*/
+class DataFile
+{
+ public:
+
+  /// Map file into memory. Check good() before use.
+  DataFile(std::string filename);
+
+  ///
+  ~DataFile();
+
+  /// False if the file could not be opened or is not a data file.
+  bool   good() const { return _base != 0; }
+
+  /// Number of rows.
+  size_t rows() const { return _nrows; }
+
+  /// Number of columns.
+  int    columns() const { return (int)_names.size(); }
+
+  /// Names of columns.
+  const std::vector<std::string>& names() const { return _names; }
+
+  /// Return index of named column, or -1 if it does not exist.
+  int    index(std::string name) const;
+
+  /// Return pointer to first value of column.
+  const float* column(int i) const;
+
+  /** Convert a text table to binary format.
+      The first line of the text file must contain the column names;
+      each following line holds one row of whitespace separated numbers.
+      @return 0 on success, -1 if a file cannot be opened, -2 if a row
+      has the wrong number of values.
+  */
+  static int convert(std::string textfile, std::string binaryfile);
+
+  /** Write columns to a binary file.
+      @return 0 on success, -1 if the file cannot be opened.
+  */
+  static int write(std::string binaryfile,
+		   const std::vector<std::string>& names,
+		   const std::vector<const float*>& columns,
+		   size_t nrows);
+
+ private:
+  std::vector<std::string> _names;
+  size_t _nrows;
+  size_t _offset;
+  size_t _colsize;
+  size_t _length;
+  char*  _base;
+
+  DataFile(const DataFile&);
+  DataFile& operator=(const DataFile&);
+};
+
+#endif
@@ -10,6 +10,16 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <cstddef>
+#include <iosfwd>
+
+#include "CompiledNetwork.h"
+#include "QuantizedNetwork.h"
+#include "ActivationTable.h"
+#include "PatternStore.h"
+#include "NetworkState.h"
+#include "ROC.h"
+#include "TrainingStats.h"
 
 typedef std::vector<float>  vfloat;
 typedef std::vector<double> vdouble;
@@ -31,11 +41,26 @@ namespace jtn {
   }; 
   
   typedef std::map<std::string, ID>    mid;
+
+  class ThreadPool;
 };
 
+class PatternStream;
+class BackProp;
+class AliasTable;
+class Permutation;
+class JetnetContext;
+
 /** Feed-forward neural network using JETNET 3.4.
     This is a wrapper around one of the first well-documented neural
     network training codes.
+    <p>
+    Each object keeps its own copy of the JETNET parameters, training
+    state and random number generator (see JetnetContext), as well as
+    its own weights, so that several objects can be trained in one
+    process, each on its own thread. Calls of JETNET routines are
+    serialized by a process-wide lock; training with methods 0, 1 and
+    2, which does not call JETNET, runs fully in parallel.
 */
 class Jetnet
 {
@@ -59,6 +84,20 @@ class Jetnet
     kLINEAR  = 1
   };
 
+  // Figure of merit used by fit()
+  enum Criterion
+  {
+    kRMS  = 0,
+    kAREA = 1
+  };
+
+  // Form of the network function written by save()
+  enum Code
+  {
+    kSTATEMENTS = 0,
+    kARRAYS     = 1
+  };
+
   // ERROR CODES
   enum Status
   {
@@ -76,7 +115,7 @@ class Jetnet
 
   /** Constructor.
    */
-  Jetnet(){}
+  Jetnet() { _defaults(); }
 
   /** Create a network.
       The network structure is specified by giving the names of the
@@ -99,6 +138,9 @@ class Jetnet
   Jetnet(std::vector<std::string>& variab, int hidden, Output output=kSIGMOID);
     
   /** Create an already-trained network, given a file of weights.
+      If the extension is .jnw, the weights are read from a binary
+      weight file (see WeightFile); otherwise they are read from the
+      JETNET (.jetnet) and MLPfit (.net) files of that name.
       @param filename - Filename of the weights
   */
   Jetnet(std::string filename);
@@ -167,29 +209,149 @@ class Jetnet
   ///
   void  setDeta(float val);
     
+  /** Set number of threads used by train() and test().
+      By default, all available hardware threads are used. The 
+      results of test() do not depend on the number of threads; those
+      of train() depend on it only through the rounding of the sums
+      over the patterns of an update.
+  */
+  void  setThreads(int nthreads);
+
   /// Set sample (0 for training, 1 for testing).
   void  setSample(Sample sample=kTRAINING);
     
   /** Set pattern.
       @param inp    - Input values
       @param out    - Output value
+      @param weight - Weight of pattern
   */
-  void  setPattern(vfloat& inp, float out);
+  void  setPattern(vfloat& inp, float out, float weight=1);
 
-  void  setPattern(vdouble& inp, double out);
+  void  setPattern(vdouble& inp, double out, double weight=1);
  
+  /** Reserve space for npatterns patterns in the current sample.
+      This avoids repeated reallocation when the number of patterns
+      is known in advance.
+  */
+  void  reserve(size_t npatterns);
+
   ///
   void  loadPatterns(vvfloat& inp,
   		     vfloat&  out);
+
+  /** Load a block of patterns from a row-major buffer in one call,
+      for example a numpy array passed through PyROOT.
+      @param data      - First value of first row
+      @param nrows     - Number of rows (patterns)
+      @param ncols     - Number of columns in each row
+      @param rowStride - Distance (in values) between successive rows
+      @param targets   - Target of each row
+      @param sample    - Sample to which the patterns are added
+      @param columns   - Column index of each network input. By default,
+                         the first columns are used, in order.
+      @param weights   - Weight of each row (by default, 1)
+  */
+  void  loadPatterns(const float* data, 
+		     size_t nrows, 
+		     size_t ncols, 
+		     size_t rowStride,
+		     const float* targets, 
+		     Sample sample,
+		     const vint& columns=vint(),
+		     const float* weights=0);
+
+  ///
+  void  loadPatterns(const double* data, 
+		     size_t nrows, 
+		     size_t ncols, 
+		     size_t rowStride,
+		     const double* targets, 
+		     Sample sample,
+		     const vint& columns=vint(),
+		     const double* weights=0);
     
+  /** Load patterns from a binary data file (see DataFile).
+      The file is memory-mapped and the network inputs are selected
+      from its columns by name.
+      @param filename - Binary data file
+      @param target   - Target value of every pattern in the file
+      @param sample   - Sample to which the patterns are added
+      @param first    - First row to load
+      @param count    - Number of rows to load (0 means all remaining)
+      @param weight   - Name of the column of pattern weights (by 
+                        default, every weight is 1)
+      @return false if the file cannot be read or lacks an input variable
+  */
+  bool  loadFile(std::string filename, 
+		 float  target, 
+		 Sample sample,
+		 size_t first=0,
+		 size_t count=0,
+		 std::string weight="");
+
+  /// Return patterns of given sample.
+  const PatternStore& patterns(Sample sample);
+
+  /** Use the patterns of another network (or any pattern store) as 
+      the given sample, without copying them. The store must outlive
+      this object and must not be changed while it is shared. Since
+      no network moves its patterns (see setShuffling), each network
+      can visit a shared sample in its own order. Adding patterns to
+      the sample afterwards ends the sharing.
+      <pre>
+      Jetnet a(vars, 10), b(vars, 20);
+      ... load patterns into a ...
+      a.begin();
+      b.sharePatterns(Jetnet::kTRAINING, a.patterns(Jetnet::kTRAINING));
+      b.sharePatterns(Jetnet::kTESTING,  a.patterns(Jetnet::kTESTING));
+      b.begin();
+      </pre>
+  */
+  void  sharePatterns(Sample sample, const PatternStore& store);
+
+  /** Add a binary data file to the training stream.
+      Streamed patterns are not loaded into memory; train() reads 
+      them from disk in blocks, while the next block is read in the 
+      background. The order of the patterns is randomized in each 
+      epoch by shuffling the blocks and passing them through a 
+      shuffle buffer (see PatternStream). Once a file has been added,
+      begin() and train() use the stream rather than the training
+      sample; test() always uses the loaded samples.
+      @param filename - Binary data file
+      @param target   - Target value of every pattern in the file
+      @param weight   - Name of the column of pattern weights (by 
+                        default, every weight is 1)
+      @return false if the file cannot be read or lacks an input variable
+  */
+  bool  addStream(std::string filename, float target, 
+		  std::string weight="");
+
+  /** Set the number of patterns read at a time from the training
+      stream and the number of patterns in its shuffle buffer. 
+      The buffer holds at least one block; a bufferSize below 
+      blockSize, such as 0, only shuffles within each block.
+      Memory use is roughly (2*blockSize + bufferSize) patterns.
+  */
+  void  setStreamBuffer(size_t blockSize, size_t bufferSize);
+
   /// Return value of network training parameter.
   float    parameter(std::string name);
 
   /// Return names of network inputs.
   vstring  names();
+
+  /// Return number of nodes in each layer, starting with the inputs.
+  vint     nodes() { return _nodes; }
     
-  /// Save network weights and, by default, the network function.
-  void  save (std::string name, bool savecpp=true);
+  /** Save network weights and, by default, the network function.
+      The weights are written in JETNET (.jetnet), MLPfit (.net) and 
+      binary (.jnw) formats. With code=kSTATEMENTS, the function is written as one statement
+      per weight. With code=kARRAYS, the weights are written as arrays
+      and the function as loops over the nodes, which compiles quickly
+      and vectorizes for large networks; the file then also defines
+      jn<name>_batch(in, n, out) for n patterns, in double or float.
+  */
+  void  save (std::string name, bool savecpp=true, Code code=kSTATEMENTS);
     
   ///
   void  printParameters(int flag=0);
@@ -199,11 +361,147 @@ class Jetnet
 
   /// Save network weights to .jetnet
   void  save();
+
+  /** Copy the current weights into memory, without writing to disk.
+      The snapshot is kept if it is among the best (lowest rms) 
+      setSnapshots() snapshots taken so far.
+      @param rms - Figure of merit, typically test(kTESTING)
+  */
+  void  snapshot(float rms);
+
+  /// Set maximum number of snapshots kept (default 5).
+  void  setSnapshots(int n);
+
+  /// Number of snapshots kept.
+  int   snapshots() { return (int)_snapshots.size(); }
+
+  /// Figure of merit of snapshot i, in increasing order (0 is the best).
+  float snapshotRMS(int i=0);
+
+  /** Make snapshot i the current network.
+      @return false if there is no such snapshot
+  */
+  bool  restore(int i=0);
     
-  /// Train network.
+  /** Set the early-stopping rule of fit().
+      @param patience  - Stop after this many epochs without a new best
+                         network (0 means never stop early)
+      @param criterion - Figure of merit on the testing sample: the
+                         rms (smaller is better) or the area under the
+                         ROC curve (larger is better)
+      @param subsample - If not 0, each epoch is first validated on 
+                         subsample testing patterns, the same for all
+                         epochs of a fit() and drawn at random when it
+                         starts; the full testing sample is used only
+                         if the subsample does not show the network
+                         to be worse than the best one
+      @param nsigma    - Width of the confidence interval, in standard
+                         errors, of the subsample figure of merit
+  */
+  void  setEarlyStopping(int patience, 
+			 Criterion criterion=kRMS,
+			 size_t subsample=0, 
+			 float nsigma=2);
+
+  /** Train for at most maxEpochs epochs, stopping early as set by
+      setEarlyStopping(). The best network is kept in memory and made
+      the current network on return. Call begin() first.
+      @return number of epochs trained
+  */
+  int   fit(int maxEpochs);
+
+  /// Epoch of the best network found by the last fit() (1 is the first).
+  int   bestEpoch() { return _bestEpoch; }
+
+  /// Figure of merit of the best network found by the last fit().
+  float bestScore() { return _bestScore; }
+
+  /** Draw the patterns of each training epoch from the training
+      sample, with replacement, in proportion to their weights, and 
+      train on them unweighted, instead of weighting each pattern. 
+      The number of draws is the size of the sample. The draws use an
+      alias table built by begin(), so each takes constant time. 
+      Resampling lets methods other than 0, 1 and 2 train on weighted
+      patterns; it does not apply to streamed samples.
+  */
+  void  setResampling(bool resample=true) { _resample = resample; }
+
+  /** Set the order in which train() visits the patterns. The patterns
+      are not moved: train() follows a permutation of their indices,
+      drawn with a fast generator (see Permutation). By default, a new
+      order is drawn for each epoch.
+      @param everyEpoch - Draw a new order for each epoch; if false, the
+                          order drawn by begin() is kept
+      @param blockSize  - If positive, shuffle within blocks of that
+                          many consecutive patterns and visit the blocks
+                          in random order, which reads memory in larger
+                          pieces (0 for a full shuffle)
+      @param seed       - Seed of the generator; if 0, it is drawn from
+                          the JETNET random numbers of this network
+                          (seeded by MRJN(1)) when begin() is called
+  */
+  void  setShuffling(bool everyEpoch=true, size_t blockSize=0, 
+		     unsigned long long seed=0);
+
+  /** Keep a normalized copy of the training and testing samples.
+      begin() computes (x - mean) / sigma once for every input of
+      every pattern, into a second store that train() and test() then
+      read directly; the copy is dropped when patterns are added to
+      the sample, and rebuilt by the next begin(). The copy doubles
+      the memory of the loaded samples, so it is off by default and
+      the inputs are normalized on the fly in every epoch. Streamed
+      samples are never copied.
+  */
+  void  setNormalizedCopy(bool keep=true);
+
+  /** Train network.
+      Methods 0, 1 and 2 are trained by a native, multi-threaded
+      back-propagation engine (see BackProp), which applies the same
+      update rules as JETNET; the other methods call JETNET (JNTRAL)
+      for each pattern. Networks larger than the JETNET limits 
+      (MAXV nodes, MAXM weights) can be trained with methods 0, 1 
+      and 2 only, and are saved in MLPfit and binary format only.
+      <p>
+      The weights are updated every patternsPerUpdate patterns, one
+      update after the other; only the patterns of an update are
+      split among the threads. The throughput therefore grows with
+      both patternsPerUpdate and the number of threads: with the
+      JETNET default of 10 patterns per update, an update holds too
+      little work for more than a few threads.
+  */
   float train();
 
+  /** Train methods 0, 1 and 2 with the native engine (the default)
+      or, if false, with JETNET (JNTRAL), for instance to check that
+      both give the same weights. JETNET accepts neither networks
+      beyond its limits nor weighted patterns.
+  */
+  void  setNativeTraining(bool native=true);
+
+  /// Counters and timers of training since begin() or resetStats().
+  const TrainingStats& stats() const { return _stats; }
+
+  /// Counters and timers of the last call to train() and of the 
+  /// calls to test() since.
+  const TrainingStats& epochStats() const { return _epochStats; }
+
+  /// Set the counters and timers to zero.
+  void  resetStats();
+
+  /** Log the statistics of each epoch (epochStats()), its training
+      error and the RMS of its last test on the testing sample, as a
+      JSON object per line. An epoch is logged when the next one
+      starts, or when logging stops.
+      @param filename - Log file; an empty name stops logging
+      @return false if the file cannot be opened
+  */
+  bool  setLog(std::string filename);
+
   /** Test on specified sample.
+      The sample is split into fixed-size chunks that are scored in
+      parallel. Each thread fills its own histograms and the partial
+      sums are combined in chunk order, so the results are 
+      bit-for-bit the same for any number of threads.
       Note: The error returned is the mean squared error.
   */
   float test(Sample sample=kTRAINING, float cutpoint=0.5, int numberBins=50);
@@ -229,9 +527,23 @@ class Jetnet
   */
   float power();
 
-  /** Compute area under the ROC curve. */
+  /** Compute area under the ROC curve. 
+      This is the binned area of the last test(); see roc() for the
+      exact area.
+  */
   float area();
 
+  /** Compute the exact ROC curve of the network on a sample, from
+      which the exact area and the best cut for a figure of merit
+      can be obtained, e.g.
+      <pre>
+      ROC r = nn.roc(Jetnet::kTESTING);
+      float auc = r.area();
+      float cut = r.cuts()[r.best(ROC::kSIGNIFICANCE, lumi*xs/ns, lumi*xb/nb)];
+      </pre>
+  */
+  ROC   roc(Sample sample=kTESTING);
+
   /** Compute network divergence.
 	
       \f$\mbox{divergence} = min(D(p|q), D(q|p)) \f$
@@ -250,18 +562,63 @@ class Jetnet
    */
   float error();
 
-  ///
-  vint histogram(int target);
+  /// Histogram of outputs of the last test(), as sums of pattern weights.
+  vdouble histogram(int target);
     
   ///
   vfloat efficiencies(int target);
 
-  /// Compute network output for a single output network.
+  /** Compute network output for a single output network.
+      The network function is a CompiledNetwork that is rebuilt
+      after each call to begin() and train(). Therefore, evaluate()
+      may be called concurrently from several threads, provided
+      that the network is not being trained at the same time.
+   */
   float evaluate(vfloat& inp);
   
   ///
   float evaluate(vdouble& inp);
 
+  /** Compute network output for a batch of patterns.
+      The patterns are processed in blocks by a native C++ kernel.
+      The outputs agree with those computed by JETNET (JNTEST) 
+      to within 1e-6 (absolute).
+      @param rows   - First input value of first pattern
+      @param n      - Number of patterns
+      @param stride - Distance (in floats) between successive patterns
+      @param out    - Array of at least n network outputs
+  */
+  void  evaluateBatch(const float* rows, size_t n, size_t stride, float* out);
+
+  /** Return a copy of the current network function.
+      The copy is independent of this object and of the JETNET 
+      common blocks; it can be shared across threads without locks.
+  */
+  CompiledNetwork compile() { return _table ? _tabulated : _network; }
+
+  /** Compute the transfer functions of evaluate(), evaluateBatch()
+      and compile() by interpolation in a table of tanh shared by the
+      whole process (see ActivationTable), and write the C++ function
+      of save() with the same table. Training and test() are not
+      affected.
+      @param maxError - Largest absolute error on tanh (at least 1e-6);
+                        0 to compute the functions exactly
+  */
+  void  setActivationTable(double maxError=1e-5);
+
+  /// Table set by setActivationTable(), or zero.
+  const ActivationTable* activationTable() { return _table; }
+
+  /** Return an integer version of the current network function.
+      The scales of the node outputs are calibrated on the given
+      sample. If there is a testing sample, the quantized network is
+      compared with the float network on it and a report is printed
+      (see QuantizedNetwork::printReport).
+      @param bits        - 8 or 16
+      @param calibration - Sample to calibrate on
+  */
+  QuantizedNetwork quantize(int bits=8, Sample calibration=kTRAINING);
+
   /** False on error.
       @see status
   */
@@ -284,8 +641,49 @@ class Jetnet
   vfloat  _sigma;
   vdouble _wgt;
 
-  vint    _s;
-  vint    _b;
+  NetworkState    _state;
+  CompiledNetwork _network;
+  const ActivationTable* _table;
+  CompiledNetwork _tabulated;   // _network, with _table
+
+  int     _nsnapshots;
+  std::vector<std::pair<float, vdouble> > _snapshots;
+
+  int       _patience;
+  Criterion _criterion;
+  size_t    _validationSize;
+  float     _nsigma;
+  int       _bestEpoch;
+  float     _bestScore;
+
+  // Scale that brings the mean weight of the training patterns to 1
+  float     _wscale;
+
+  // Weighted resampling of the training patterns in each epoch
+  bool      _resample;
+  vint      _draws;
+
+  // Order of the training patterns
+  bool      _reshuffle;
+  size_t    _shuffleBlock;
+  unsigned long long _shuffleSeed;
+
+  // Methods 0, 1 and 2 trained by BackProp rather than JNTRAL
+  bool      _native;
+
+  // Inputs of the samples, normalized by begin() (see setNormalizedCopy)
+  bool      _prenormalize;
+  std::map<Jetnet::Sample, PatternStore> _normalized;
+
+  // Statistics since begin(), of the current epoch, and its log
+  TrainingStats _stats;
+  TrainingStats _epochStats;
+  float     _epochError;
+  float     _epochRMS;
+  bool      _logPending;
+
+  vdouble _s;
+  vdouble _b;
   vfloat  _es;
   vfloat  _eb;
   float   _power;
@@ -293,6 +691,8 @@ class Jetnet
   float   _divergencebyMC;
   float   _error;
   float   _rms;
+  float   _rmserror;
+  double  _neff;
   float   _area;
 
   int     _ninput;
@@ -302,15 +702,53 @@ class Jetnet
 
   jtn::mid     _id;
 
-  std::map<Jetnet::Sample, vvfloat> _input;
-  std::map<Jetnet::Sample, vfloat>  _output;
+  std::map<Jetnet::Sample, PatternStore> _input;
+  std::map<Jetnet::Sample, const PatternStore*> _shared;
 
   bool _load (std::string filename, int which=1);    
+  void _defaults();
   void _findscale();
+  void _normalize();
+  const PatternStore* _normalizedSample(Sample sample);
+  PatternStore& _patterns(Sample sample);
+  const PatternStore& _samples(Sample sample);
+  bool  _columns(size_t ncols, const vint& columns, vint& cols);
+  bool _loadBinary(std::string filename);
+  void _getweights();
+  void _setweights();
+  void _compile();
   void _init(std::string vars="", int hidden=-1, Output outType=kSIGMOID);
-  void _setpattern(Sample sample);
+  void _train(const PatternStore& input, const vint* rows=0, 
+	      bool draws=false, bool normalized=false);
+  void _resampling();
+  void _logEpoch();
+  float _test(Sample sample, float cutpoint, int nbin, 
+	      const PatternStore* subsample=0);
+  float _loss(float& error);
+  void _shuffling();
+  unsigned long long _seed();
   void _setParameter(std::string name);
-  void _saveCPP(std::string filename);
+  void _saveCPP(std::string filename, Code code=kSTATEMENTS);
+
+  int              _nthreads;
+  jtn::ThreadPool* _pool;
+  jtn::ThreadPool* _threadpool();
+
+  PatternStream*   _stream;
+  PatternStream*   _patternstream();
+
+  BackProp*        _backprop;
+  AliasTable*      _alias;
+  Permutation*     _order;
+  std::ostream*    _log;
+
+  JetnetContext*   _ctx;
+  JetnetContext*   _context();
+
+  // Not copyable (owns a thread pool, a pattern stream, a trainer,
+  // an alias table, a permutation, a log and a JETNET context)
+  Jetnet(const Jetnet&);
+  Jetnet& operator=(const Jetnet&);
 };
 
 #endif
@@ -0,0 +1,64 @@
+#ifndef JETNETCONTEXT_H
+#define JETNETCONTEXT_H
+//-----------------------------------------------------------------------------
+// File: JetnetContext.h
+// Purpose: Per-instance copy of the JETNET switches, parameters and state
+// Created: 18-Oct-2026
+//-----------------------------------------------------------------------------
+#include "jncommon.h"
+
+/** Private copy of the JETNET common blocks, except the network
+    arrays (see NetworkState) and the pattern arrays.
+    JETNET keeps its switches, parameters, training state and random
+    number generator in common blocks shared by the whole process.
+    Each Jetnet object keeps them in its own JetnetContext instead,
+    and the native code (BackProp, NetworkState) reads and updates
+    the context, so that several objects can be trained at the same
+    time on different threads. Calls of JETNET routines must be
+    bracketed by enter() and leave(), which serialize them with a
+    process-wide lock and swap the context into and out of the common
+    blocks.
+*/
+class JetnetContext
+{
+ public:
+
+  /// Create context holding the JETNET defaults.
+  JetnetContext();
+
+  /** Lock the JETNET common blocks and copy this context into them.
+      Every call must be followed by a call of leave() on the same
+      thread.
+  */
+  void  enter();
+
+  /// Copy the common blocks back into this context and unlock them.
+  void  leave();
+
+  /// Uniform random number in ]0,1[, from the same generator as RJN.
+  float rjn();
+
+  /// Gaussian random number, from the same generator as GAUSJN.
+  float gausjn();
+
+  // /JNDAT1/, without OIN and OUT
+
+  int    mstjn[40];
+  float  parjn[40];
+  int    mstjm[20];
+  float  parjm[20];
+  int    mxndjm;
+
+  jndat2 dat2;
+  jnint2 int2;
+  jnint3 int3;
+  jnint4 int4;
+  jndatr datr;
+  jngaus gaus;
+
+ private:
+  void _load();
+  void _store() const;
+};
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef NETWORKSTATE_H
+#define NETWORKSTATE_H
+//-----------------------------------------------------------------------------
+// File: NetworkState.h
+// Purpose: Heap-allocated weights and thresholds of a JETNET network
+// Created: 18-Oct-2026
+//-----------------------------------------------------------------------------
+#include <vector>
+
+class JetnetContext;
+
+/** Weights, thresholds and their increments of a network.
+    The data members mirror the network parts of the JETNET common
+    blocks /JNINT1/ and /JNINT2/, with the same layout and indexing,
+    but are sized from the actual network rather than from the
+    compile-time limits MAXV and MAXM. A network that fits in the
+    common blocks can be copied to and from them with store() and
+    load(), so that the JETNET routines can be used; a larger network
+    is set up by initialize() and can then be trained only by the
+    native engine (see BackProp).
+*/
+class NetworkState
+{
+ public:
+
+  ///
+  NetworkState();
+
+  /// True if a network with the given nodes per layer fits in the
+  /// JETNET common blocks.
+  static bool fits(const std::vector<int>& nodes);
+
+  /// True if this network fits in the JETNET common blocks.
+  bool fits() const;
+
+  /// False if no network has been set up.
+  bool good() const { return nl > 0; }
+
+  /// Number of nodes per layer.
+  std::vector<int> nodes() const { return m; }
+
+  /** Set up the network defined by MSTJN, IGFN and WIDL of a context,
+      as JNINIT does, without using the JETNET network arrays. The
+      layout is also written to the context's /JNINT2/, and the
+      weights and thresholds are drawn from its random numbers.
+  */
+  void initialize(JetnetContext& jn);
+
+  /// Copy network from the JETNET common blocks.
+  void load();
+
+  /// Copy network into the JETNET common blocks. Requires fits().
+  void store() const;
+
+  /// Return weights and thresholds in MLPfit ordering.
+  void weights(std::vector<double>& weight) const;
+
+  /// Set weights and thresholds from MLPfit ordering.
+  void setWeights(const std::vector<double>& weight);
+
+  // Layout, as in /JNINT2/; layer 0 holds the inputs
+
+  int nl;                   ///< Number of layers, excluding the inputs
+  std::vector<int> m;       ///< Nodes in layers 0,...,nl
+  std::vector<int> mv0;     ///< Offset of thresholds of layers 1,...,nl+1
+  std::vector<int> mm0;     ///< Offset of weights of layers 1,...,nl+1
+  std::vector<int> ng;      ///< Transfer function of layers 1,...,nl
+  int nw;                   ///< Number of weights
+  int nt;                   ///< Number of thresholds
+
+  // Network, as in /JNINT1/
+
+  std::vector<float> w;
+  std::vector<float> t;
+  std::vector<float> dw;
+  std::vector<float> dt;
+  std::vector<int>   nself;      // 1 if weight is updated, else 0
+  std::vector<int>   ntself;     // 1 if threshold is updated, else 0
+
+  // State of the JETNET methods other than 0, 1 and 2, kept only
+  // for networks that fit in the common blocks
+
+  std::vector<float> g;
+  std::vector<float> odw;
+  std::vector<float> odt;
+  std::vector<float> etav;
+
+ private:
+  void _layout(const std::vector<int>& nodes);
+};
+
+#endif
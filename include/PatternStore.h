@@ -0,0 +1,141 @@
+#ifndef PATTERNSTORE_H
+#define PATTERNSTORE_H
+//-----------------------------------------------------------------------------
+// File: PatternStore.h
+// Purpose: Contiguous storage of training and testing patterns
+// Created: 18-Oct-2026
+//-----------------------------------------------------------------------------
+#include <vector>
+#include <cstddef>
+
+/** Contiguous store of patterns, their targets and their weights.
+    The inputs are kept row-major in a single arena aligned to
+    PatternStore::ALIGN bytes. Rows are packed, columns() floats
+    apart, unless the store is created with aligned rows, in which
+    case each row is padded to a multiple of ALIGN bytes so that every
+    row starts on an aligned boundary.
+    Appending a pattern does not allocate unless the capacity is
+    exhausted, in which case the capacity is doubled. Use reserve()
+    to size the store up front.
+    <p>
+    Weights are stored only once a pattern with a weight other than 1
+    has been added; until then every weight is 1 and weighted() is
+    false.
+*/
+class PatternStore
+{
+ public:
+  enum { ALIGN = 64 };
+
+  /** Create store for patterns with ncolumns inputs.
+      @param ncolumns - Number of inputs
+      @param aligned  - Pad each row to a multiple of ALIGN bytes
+  */
+  PatternStore(int ncolumns=0, bool aligned=false);
+
+  ///
+  PatternStore(const PatternStore& other);
+
+  ///
+  PatternStore& operator=(const PatternStore& other);
+
+  ///
+  ~PatternStore();
+
+  /// Reserve space for at least npatterns patterns.
+  void   reserve(size_t npatterns);
+
+  /// Number of patterns that can be stored without reallocating.
+  size_t capacity() const { return _capacity; }
+
+  /// Number of patterns.
+  size_t size() const { return _size; }
+
+  /// Number of inputs per pattern.
+  int    columns() const { return _ncolumns; }
+
+  /// Distance (in floats) between successive patterns.
+  size_t stride() const { return _stride; }
+
+  /// Remove all patterns (the capacity is unchanged).
+  void   clear() { _size = 0; _target.clear(); _weight.clear(); }
+
+  /// Append a pattern; inp must hold at least columns() values.
+  void   add(const float* inp, float target, float weight=1);
+
+  ///
+  void   add(const double* inp, float target, float weight=1);
+
+  /** Append n patterns from a row-major buffer.
+      @param data    - First value of first row
+      @param n       - Number of rows
+      @param stride  - Distance (in values) between successive rows
+      @param columns - Index of the column to use for each input
+      @param targets - Target of each row
+      @param weights - Weight of each row (0 means all weights are 1)
+  */
+  void   add(const float* data, size_t n, size_t stride,
+	     const int* columns, const float* targets,
+	     const float* weights=0);
+
+  ///
+  void   add(const double* data, size_t n, size_t stride,
+	     const int* columns, const double* targets,
+	     const double* weights=0);
+
+  /** Append n patterns from columnar data, all with the same target.
+      @param columns - Pointer to first value of each input column
+      @param n       - Number of rows
+      @param target  - Target of every row
+      @param weights - Weight of each row (0 means all weights are 1)
+  */
+  void   add(const float* const* columns, size_t n, float target,
+	     const float* weights=0);
+
+  /// Return pointer to inputs of pattern i.
+  float*       row(size_t i)       { return _data + i * _stride; }
+
+  ///
+  const float* row(size_t i) const { return _data + i * _stride; }
+
+  /// Return pointer to inputs of first pattern.
+  const float* data() const { return _data; }
+
+  /// Return target of pattern i.
+  float  target(size_t i) const { return _target[i]; }
+
+  /// Return pointer to targets.
+  const float* targets() const { return _target.data(); }
+
+  /// True if any pattern has a weight other than 1.
+  bool   weighted() const { return !_weight.empty(); }
+
+  /// Return weight of pattern i.
+  float  weight(size_t i) const { return _weight.empty() ? 1 : _weight[i]; }
+
+  /// Return pointer to weights, or 0 if not weighted().
+  const float* weights() const { return _weight.empty() ? 0 : _weight.data(); }
+
+  /// Remove pattern i by moving the last pattern into its place.
+  void   remove(size_t i);
+
+ private:
+  int    _ncolumns;
+  size_t _stride;
+  size_t _size;
+  size_t _capacity;
+  float* _data;
+  std::vector<float> _target;
+  std::vector<float> _weight;
+
+  float* _grow();
+
+  template <class T>
+  void   _add(const T* data, size_t n, size_t stride,
+	      const int* columns, const T* targets, const T* weights);
+
+  template <class T>
+  void   _addWeights(size_t first, size_t n, const T* weights);
+};
+
+#endif
@@ -0,0 +1,138 @@
+#ifndef PATTERNSTREAM_H
+#define PATTERNSTREAM_H
+//-----------------------------------------------------------------------------
+// File: PatternStream.h
+// Purpose: Stream shuffled training patterns from binary data files
+// Created: 18-Oct-2026
+//-----------------------------------------------------------------------------
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <random>
+
+#include "PatternStore.h"
+
+class DataFile;
+
+/** Stream of training patterns read from binary data files.
+    The patterns are never all held in memory. Each epoch, the rows of
+    all files are visited in blocks of blockSize rows, in a random
+    block order. A background thread reads the next block while the
+    current one is used (double buffering). The blocks flow through an
+    in-memory shuffle buffer of bufferSize patterns, from which
+    patterns are drawn at random. Together these approximate a global
+    shuffle of the sample.
+*/
+class PatternStream
+{
+ public:
+
+  /** Create stream of patterns with ncolumns inputs.
+      @param ncolumns   - Number of inputs per pattern
+      @param blockSize  - Number of consecutive rows read at a time
+      @param bufferSize - Number of patterns in the shuffle buffer
+      @param seed       - Seed of the random number generator
+  */
+  PatternStream(int ncolumns, 
+		size_t blockSize=16384, 
+		size_t bufferSize=262144,
+		unsigned int seed=12345);
+
+  ///
+  ~PatternStream();
+
+  /** Add a binary data file (see DataFile).
+      @param filename - Binary data file
+      @param target   - Target value of every pattern in the file
+      @param names    - Names of the columns to use as inputs
+      @param weight   - Name of the column of pattern weights; if
+                        empty, every weight is 1
+      @return 0 on success, -1 if the file cannot be read, -2 if a
+      column is missing.
+  */
+  int    add(std::string filename, float target,
+	     const std::vector<std::string>& names,
+	     std::string weight="");
+
+  /// Total number of patterns.
+  size_t size() const;
+
+  /// Number of inputs per pattern.
+  int    columns() const { return _ncolumns; }
+
+  /// Set number of rows per block (and per chunk returned by next()).
+  void   setBlockSize(size_t n) { if ( n > 0 ) _blocksize = n; }
+
+  /// Set number of patterns in the shuffle buffer. The buffer holds
+  /// at least one block, so sizes below blockSize (including 0) only
+  /// shuffle within each block.
+  void   setBufferSize(size_t n) { _buffersize = n; }
+
+  /** Compute mean and variance of each input over all patterns, in
+      one pass per column (Welford's update within blocks of rows,
+      merged by Chan's formula), without the cancellation of the mean
+      square minus the squared mean.
+      @return mean weight of the patterns
+  */
+  double moments(std::vector<double>& mean, std::vector<double>& variance);
+
+  /// Start a new pass through the patterns.
+  void   start();
+
+  /** Get next chunk of (at most blockSize) shuffled patterns.
+      @return false at the end of the pass
+  */
+  bool   next(PatternStore& chunk);
+
+  /// Stop the current pass (waits for the prefetch thread).
+  void   stop();
+
+ private:
+  struct Source
+  {
+    DataFile* file;
+    float     target;
+    std::vector<const float*> columns;
+    const float* weight;
+  };
+
+  struct Block
+  {
+    int    source;
+    size_t first;
+    size_t count;
+  };
+
+  int    _ncolumns;
+  size_t _blocksize;
+  size_t _buffersize;
+  std::mt19937 _random;
+
+  std::vector<Source> _sources;
+  std::vector<Block>  _blocks;
+  std::vector<int>    _order;
+
+  // Shuffle buffer
+  PatternStore _pool;
+
+  // Double buffer filled by the prefetch thread
+  PatternStore _slot[2];
+  std::vector<int> _filled;
+  std::vector<int> _free;
+  bool         _done;
+  bool         _cancel;
+  std::thread  _prefetch;
+  std::mutex   _mutex;
+  std::condition_variable _changed;
+
+  void _produce();
+  bool _fetch();
+
+  PatternStream(const PatternStream&);
+  PatternStream& operator=(const PatternStream&);
+};
+
+#endif
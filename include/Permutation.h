@@ -0,0 +1,72 @@
+#ifndef PERMUTATION_H
+#define PERMUTATION_H
+//-----------------------------------------------------------------------------
+// File: Permutation.h
+// Purpose: Random order of the patterns of a sample, redrawn every epoch
+// Created: 18-Oct-2026
+//-----------------------------------------------------------------------------
+#include <vector>
+#include <cstddef>
+#include <stdint.h>
+
+/** Random permutation of the indices 0,...,n-1, for visiting the
+    patterns of a sample in a new order every epoch without moving
+    them. The indices are reshuffled in place (Fisher-Yates), so a new
+    order costs one random number per pattern and no memory beyond the
+    indices themselves. The random numbers come from splitmix64, which
+    is fast and reproducible from a single 64-bit seed.
+    <p>
+    With a block size, the permutation is block-local: the sample is
+    cut into blocks of consecutive patterns, the blocks are visited in
+    random order and the patterns of each block in random order. Each
+    block is then read from a small region of memory, at the price of
+    less mixing between distant patterns.
+*/
+class Permutation
+{
+ public:
+
+  ///
+  Permutation(uint64_t seed=0) : _state(seed) {}
+
+  /// Restart the random numbers from seed.
+  void   seed(uint64_t seed) { _state = seed; }
+
+  /** Draw a new order of the indices 0,...,n-1.
+      @param n     - Number of indices
+      @param block - Block size for block-local shuffling (0 for none)
+      @return the indices, in their new order
+  */
+  const std::vector<int>& shuffle(size_t n, size_t block=0);
+
+  /// The indices, in the order of the last shuffle().
+  const std::vector<int>& order() const { return _order; }
+
+  /// Number of indices.
+  size_t size() const { return _order.size(); }
+
+  /// Next 64 random bits (splitmix64).
+  uint64_t next()
+  {
+    uint64_t z = (_state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+  }
+
+  /// Random integer in [0, n), by multiplication rather than division
+  /// (the bias is below n/2^32).
+  uint32_t below(uint32_t n)
+  {
+    return (uint32_t)(((next() >> 32) * (uint64_t)n) >> 32);
+  }
+
+ private:
+  uint64_t _state;
+  std::vector<int> _order;
+  std::vector<int> _blocks;
+
+  void _shuffle(int* first, size_t n);
+};
+
+#endif
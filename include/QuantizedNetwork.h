@@ -0,0 +1,152 @@
+#ifndef QUANTIZEDNETWORK_H
+#define QUANTIZEDNETWORK_H
+//-----------------------------------------------------------------------------
+// File: QuantizedNetwork.h
+// Purpose: Integer (8- or 16-bit) network function for fast scoring
+// Created: 18-Oct-2026
+//-----------------------------------------------------------------------------
+#include <string>
+#include <vector>
+#include <cstddef>
+
+class CompiledNetwork;
+
+/** Feed-forward network function in integer arithmetic.
+    The weights of each layer are stored as 8- or 16-bit integers with
+    one scale per layer, and so are the node outputs, whose scales are
+    calibrated on a sample of patterns (the largest absolute value of
+    each layer). The products are summed in 32-bit integers, over
+    blocks of patterns or over the inputs of a node, so that the loops
+    vectorize; the batch kernel is compiled per instruction set and
+    chosen at run time, as in nnkernel. To keep the sums within 32
+    bits, the integer range of 16-bit networks is capped by the widest
+    layer (about 13 bits for 20 inputs, 12 bits for 100). The transfer
+    function is a table of tanh (or of the output sigmoid), linearly
+    interpolated, on [-8, 8]: 256 intervals for 8-bit networks, 4096
+    for 16-bit networks.
+    <p>
+    Like a CompiledNetwork, a QuantizedNetwork is immutable and can be
+    shared by any number of threads. save() writes the same function
+    as self-contained C++; both give the same outputs. compare()
+    measures the loss of accuracy with respect to the float network.
+*/
+class QuantizedNetwork
+{
+ public:
+
+  ///
+  QuantizedNetwork();
+
+  /** Quantize a network.
+      @param net    - Float network (hidden nodes tanh, output sigmoid
+                      or linear)
+      @param rows   - First input value of first calibration pattern
+      @param n      - Number of calibration patterns
+      @param stride - Distance (in floats) between successive patterns
+      @param bits   - 8 or 16
+  */
+  QuantizedNetwork(const CompiledNetwork& net,
+		   const float* rows, size_t n, size_t stride,
+		   int bits=8);
+
+  /// Compute network output for a single pattern.
+  float evaluate(const float* inp) const;
+
+  ///
+  float evaluate(const double* inp) const;
+
+  ///
+  float evaluate(const std::vector<float>& inp) const;
+
+  ///
+  float evaluate(const std::vector<double>& inp) const;
+
+  /** Compute network output for a batch of patterns.
+      @param rows   - First input value of first pattern
+      @param n      - Number of patterns
+      @param stride - Distance (in floats) between successive patterns
+      @param out    - Array of at least n network outputs
+  */
+  void  evaluate(const float* rows, size_t n, size_t stride,
+		 float* out) const;
+
+  /// Bits per weight and node output (8 or 16).
+  int   bits() const { return _bits; }
+
+  /// Number of inputs.
+  int   inputs() const { return _nodes.size() > 0 ? _nodes[0] : 0; }
+
+  /// False if the network has no weights.
+  bool  good() const { return _nodes.size() > 0; }
+
+  /** Write the network as a C++ function float name(const float* inp),
+      where name is the name of the file without extension.
+      @return false if the file cannot be written
+  */
+  bool  save(std::string filename) const;
+
+  /** Compare with the float network on a sample; the results are
+      kept, see maxDeviation() to printReport().
+      @param reference - Float network
+      @param rows      - First input value of first pattern
+      @param n         - Number of patterns
+      @param stride    - Distance (in floats) between successive patterns
+      @param target    - Target of each pattern
+      @param weight    - Weight of each pattern (optional)
+  */
+  void  compare(const CompiledNetwork& reference,
+		const float* rows, size_t n, size_t stride,
+		const float* target, const float* weight=0);
+
+  /// Largest absolute difference from the float network's output.
+  double maxDeviation() const { return _maxdev; }
+
+  /// RMS difference from the float network's output.
+  double rmsDeviation() const { return _rmsdev; }
+
+  /// Exact area under the ROC curve of this network.
+  double area() const { return _area; }
+
+  /// Exact area under the ROC curve of the float network.
+  double referenceArea() const { return _refarea; }
+
+  /// Print the results of compare().
+  void  printReport() const;
+
+ private:
+  int   _bits;
+  int   _qmax;          // Largest integer value
+  int   _intervals;     // Intervals of the activation tables
+  int   _outputType;
+  int   _maxnodes;
+  std::vector<int>   _nodes;
+  std::vector<float> _mean;
+  std::vector<float> _sigma;
+
+  // Per layer l = 1,...: table units per accumulator unit, and the
+  // value of the pre-activation (linear output) per accumulator unit
+  std::vector<float> _requant;
+  std::vector<float> _unit;
+  float _inscale;       // Integer units per normalized input
+
+  std::vector<signed char> _w8;   // Weights, per node, 8-bit networks
+  std::vector<short>       _w16;  // Weights, per node, 16-bit networks
+  std::vector<int>         _bias; // Thresholds, in accumulator units
+  std::vector<int>   _table;      // Tanh, per hidden layer, in integer
+                                  // units of the next layer
+  std::vector<float> _outtable;   // Sigmoid of output node
+
+  double _maxdev;
+  double _rmsdev;
+  double _area;
+  double _refarea;
+  size_t _ncompared;
+
+  template <class Q> float _single(const float* x) const;
+  template <class Q> void  _batch(const float* rows, size_t n, 
+				  size_t stride, float* out) const;
+  template <class T> float _evaluate(const T* inp) const;
+  template <class Q> const Q* _weights() const;
+};
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef ROC_H
+#define ROC_H
+//-----------------------------------------------------------------------------
+// File: ROC.h
+// Purpose: Exact ROC curve, area and optimal cut from sorted outputs
+// Created: 18-Oct-2026
+//-----------------------------------------------------------------------------
+#include <vector>
+#include <cstddef>
+
+namespace jtn { class ThreadPool; };
+
+/** Exact receiver operating characteristic of a network.
+    The network outputs of a sample are sorted once, in parallel, which
+    takes O(n log n) time; the curve, its area and the best cut are
+    then found in one pass over the sorted outputs. Unlike the
+    histograms of Jetnet::test, the results do not depend on a
+    binning: there is a point for each distinct output value.
+    Patterns with target &gt; 0.5 are signal, the others background.
+    If pattern weights are given, every count below is a sum of weights.
+    Patterns whose output is NaN (a diverged network) pass no cut; they
+    count in the totals and in the area as tied below every other
+    output.
+*/
+class ROC
+{
+ public:
+
+  // Standard figures of merit of a cut, in terms of the expected
+  // numbers of signal (s) and background (b) events that pass it
+  enum FigureOfMerit
+  {
+    kSIGNIFICANCE = 0,   ///< s/sqrt(b); points with b = 0 rank last
+    kSOVERSQRTSB  = 1    ///< s/sqrt(s+b)
+  };
+
+  ///
+  ROC();
+
+  /** Build curve from network outputs and targets.
+      @param output - Network output of each pattern
+      @param target - Target of each pattern
+      @param n      - Number of patterns
+      @param pool   - Threads used for sorting (optional)
+      @param weight - Weight of each pattern (optional)
+  */
+  ROC(const float* output, const float* target, size_t n,
+      jtn::ThreadPool* pool=0, const float* weight=0);
+
+  /// Number of points (distinct output values).
+  int    size() const { return (int)_cut.size(); }
+
+  /// Number of signal patterns.
+  double signals() const { return _nsignal; }
+
+  /// Number of background patterns.
+  double backgrounds() const { return _nbackground; }
+
+  /// Number of patterns whose output is NaN.
+  size_t invalid() const { return _ninvalid; }
+
+  /** Exact area under the curve: the probability that a signal
+      pattern has a higher output than a background pattern, with
+      ties counted as one half.
+  */
+  double area() const { return _area; }
+
+  /// Cut of each point, in decreasing order; a pattern passes if its
+  /// output is at least the cut.
+  const std::vector<float>& cuts() const { return _cut; }
+
+  /// Fraction of signal that passes the cut of each point.
+  std::vector<float> signalEfficiency() const;
+
+  /// Fraction of background that passes the cut of each point.
+  std::vector<float> backgroundEfficiency() const;
+
+  /** Return the point (index into cuts()) that maximizes a standard
+      figure of merit, or -1 if there is none.
+      @param fom    - Figure of merit
+      @param sscale - Expected signal events per signal pattern
+      @param bscale - Expected background events per background pattern
+  */
+  int    best(FigureOfMerit fom, double sscale=1, double bscale=1) const;
+
+  /// Same as above, for a user-given figure of merit fom(s, b).
+  int    best(double (*fom)(double s, double b),
+	      double sscale=1, double bscale=1) const;
+
+ private:
+  std::vector<float>  _cut;
+  std::vector<double> _ns;   // Signal weight that passes each cut
+  std::vector<double> _nb;   // Background weight that passes each cut
+  double _nsignal;
+  double _nbackground;
+  double _area;
+  size_t _ninvalid;
+};
+
+#endif
@@ -0,0 +1,151 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+//-----------------------------------------------------------------------------
+// File: Sweep.h
+// Purpose: Parallel hyperparameter sweep with successive halving
+// Created: 18-Oct-2026
+//-----------------------------------------------------------------------------
+#include <string>
+#include <vector>
+
+#include "Jetnet.h"
+
+/** Train many networks with different parameters on the same patterns.
+    The networks are trained on the patterns of a given network, which
+    are shared, not copied (see Jetnet::sharePatterns), by a fixed
+    number of worker threads. The parameters are taken either from
+    a grid (every combination of the given values) or drawn at random.
+    <p>
+    Poor networks are stopped early by successive halving: all networks
+    are trained for a first number of epochs and scored by their RMS
+    on the testing sample (Jetnet::test); the best 1/reduction of them
+    are trained for reduction times as many epochs, and so on, until
+    one network is left or the maximum number of epochs is reached.
+    <pre>
+    Sweep sweep(nn);          // nn holds the training and testing samples
+    sweep.add("hidden", hidden);
+    sweep.add("eta", 0.001, 0.1, true);
+    sweep.setRandom(50);
+    sweep.setEpochs(10, 1000);
+    sweep.run();
+    sweep.write("sweep.txt");
+    sweep.best().save("bestnet");
+    </pre>
+*/
+class Sweep
+{
+ public:
+
+  /** Create a sweep over networks with the inputs of data.
+      Parameters that are not swept keep their JETNET defaults, except
+      the number of hidden nodes and the output type, which are those
+      of data.
+  */
+  Sweep(Jetnet& data);
+
+  ///
+  ~Sweep();
+
+  /** Values of a parameter to try.
+      @param name   - "hidden" (number of hidden nodes) or any name
+                      accepted by Jetnet::setParameter
+      @param values - Values
+  */
+  void  add(std::string name, const std::vector<float>& values);
+
+  /** Range of a parameter for random search.
+      Values are drawn uniformly in [low, high], or uniformly in
+      log(value) if logscale is true. The number of hidden nodes is
+      rounded to the nearest integer.
+  */
+  void  add(std::string name, float low, float high, bool logscale=false);
+
+  /** Draw n parameter sets at random instead of using the grid.
+      Each parameter is drawn independently, from its values or its
+      range. Required if a range has been given.
+  */
+  void  setRandom(int n, int seed=1);
+
+  /** Set the schedule of successive halving.
+      @param first     - Epochs of every network in the first round
+      @param total     - Maximum number of epochs of a network
+      @param reduction - Fraction (1/reduction) of networks kept, and
+                         factor by which the epochs grow, in each round
+  */
+  void  setEpochs(int first, int total, int reduction=3);
+
+  /// Set number of networks trained at the same time (default: all cores).
+  void  setWorkers(int n);
+
+  /** Train and rank the networks.
+      @return false if the parameters are invalid or data has no
+      testing patterns
+  */
+  bool  run();
+
+  /// Number of networks (parameter sets).
+  int   size() { return (int)_results.size(); }
+
+  /** Test RMS of network of given rank, ranked first by the number of
+      epochs it survived and then by RMS (rank 0 is the best).
+  */
+  float rms(int rank);
+
+  /// Number of epochs for which network of given rank was trained.
+  int   epochs(int rank);
+
+  /// Value of parameter name of network of given rank.
+  float value(int rank, std::string name);
+
+  /** Network of given rank, or 0 if it was stopped before the last
+      round (its weights are not kept).
+  */
+  Jetnet* network(int rank);
+
+  /// Best network, to be saved with Jetnet::save.
+  Jetnet& best() { return *network(0); }
+
+  /** Write ranked table of results, one network per line.
+      @return false if the file cannot be opened
+  */
+  bool  write(std::string filename);
+
+ private:
+  struct Range
+  {
+    std::string name;
+    std::vector<float> values;
+    float low;
+    float high;
+    bool  logscale;
+  };
+
+  struct Result
+  {
+    std::vector<float> values;
+    int     epochs;
+    float   rms;
+    Jetnet* network;
+  };
+
+  Jetnet& _data;
+  std::vector<Range>  _ranges;
+  std::vector<Result> _results;
+
+  int _nrandom;
+  int _seed;
+  int _first;
+  int _total;
+  int _reduction;
+  int _workers;
+
+  bool _configure();
+  void _train(Result& result, int epochs);
+  void _clear();
+
+  // Not copyable (owns the networks)
+  Sweep(const Sweep&);
+  Sweep& operator=(const Sweep&);
+};
+
+#endif
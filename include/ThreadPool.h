@@ -0,0 +1,65 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+//-----------------------------------------------------------------------------
+// File: ThreadPool.h
+// Purpose: Fixed-size pool of worker threads
+// Created: 18-Oct-2026
+//-----------------------------------------------------------------------------
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+
+namespace jtn {
+
+  /** Fixed-size pool of persistent worker threads.
+      run() hands out the task indices 0..ntasks-1 to the workers and
+      to the calling thread, and returns when all tasks are done.
+      Which thread executes which task is not deterministic; callers
+      that need reproducible results must make each task write to its
+      own slot and combine the slots in task order.
+  */
+  class ThreadPool
+  {
+  public:
+    /// Create a pool using nthreads threads in total (including caller).
+    explicit ThreadPool(int nthreads);
+
+    ///
+    ~ThreadPool();
+
+    /// Total number of threads, including the calling thread.
+    int  size() const { return _nthreads; }
+
+    /** Execute task(index, thread) for index = 0,...,ntasks-1.
+	thread is in [0, size()) and identifies the executing thread,
+	so that it can be used to select per-thread scratch space.
+    */
+    void run(int ntasks, const std::function<void(int, int)>& task);
+
+  private:
+    int _nthreads;
+    std::vector<std::thread> _workers;
+
+    std::mutex              _mutex;
+    std::condition_variable _start;
+    std::condition_variable _done;
+
+    const std::function<void(int, int)>* _task;
+    int              _ntasks;
+    std::atomic<int> _next;
+    int              _busy;
+    long             _generation;
+    bool             _stop;
+
+    void _work(int thread);
+    void _drain(int thread);
+
+    ThreadPool(const ThreadPool&);
+    ThreadPool& operator=(const ThreadPool&);
+  };
+};
+
+#endif
@@ -0,0 +1,125 @@
+#ifndef TRAININGSTATS_H
+#define TRAININGSTATS_H
+//-----------------------------------------------------------------------------
+// File: TrainingStats.h
+// Purpose: Counters and timers of the training loop
+// Created: 18-Oct-2026
+//-----------------------------------------------------------------------------
+#include <string>
+#include <chrono>
+
+/** Counters and timers of training.
+    The timers read a steady clock once per block of patterns or per
+    weight update, never per pattern, so their cost is small next to
+    that of training. Defining JNNOSTATS at compile time turns every
+    timer into a constant, leaving only the counters.
+    <p>
+    Phase times are summed over threads, so with several threads they
+    can exceed the elapsed time. The JETNET methods (3 and above) run
+    inside JNTRAL, whose forward and backward passes cannot be timed
+    separately: their passes are counted as kJETNET, and the calls of
+    JNTRAL that update the weights (including the pass of the pattern
+    that triggers the update) as kUPDATE.
+*/
+class TrainingStats
+{
+ public:
+
+  enum Phase
+  {
+    kFORWARD  = 0,  ///< Forward passes (methods 0, 1 and 2)
+    kBACKWARD = 1,  ///< Backward passes and gradients (methods 0, 1 and 2)
+    kUPDATE   = 2,  ///< Weight updates, including line searches
+    kJETNET   = 3,  ///< Passes inside JNTRAL (other methods)
+    kTEST     = 4,  ///< test()
+    kNPHASES  = 5
+  };
+
+  ///
+  TrainingStats() { reset(); }
+
+  /// Set all counters and timers to zero.
+  void   reset();
+
+  /// Add the counters and timers of other.
+  void   add(const TrainingStats& other);
+
+  /// Number of calls to train().
+  int    epochs() const { return _epochs; }
+
+  /// Number of patterns trained on.
+  double patterns() const { return _patterns; }
+
+  /// Elapsed time of train() calls, in seconds.
+  double seconds() const { return _seconds; }
+
+  /// Patterns trained on per second of train().
+  double patternsPerSecond() const
+  { return _seconds > 0 ? _patterns / _seconds : 0; }
+
+  /// Time spent in phase, in seconds.
+  double time(Phase phase) const { return _time[phase]; }
+
+  /// Number of weight updates.
+  long   updates() const { return _updates; }
+
+  /// Number of line-search iterations (calls of JNLINS, methods 4-8).
+  long   lineSearchIterations() const { return _iterations; }
+
+  /// Number of completed line searches (methods 4-8).
+  long   lineSearches() const { return _searches; }
+
+  /// Most iterations of a single line search, to compare with
+  /// MSTJN(35).
+  int    longestLineSearch() const { return _longest; }
+
+  /// Restarts of Quickprop, line search or scaled conjugate gradient
+  /// since initialization, MSTJN(38); the program stops when they
+  /// exceed MSTJN(36).
+  int    restarts() const { return _restarts; }
+
+  /// Number of JETNET warnings (JNWARN), from MSTJN(34).
+  int    warnings() const { return _warnings; }
+
+  /// Code of the latest JETNET warning, MSTJN(33).
+  int    lastWarning() const { return _lastWarning; }
+
+  /** Return statistics as a single-line JSON object.
+      @param epoch - Epoch number to include (omitted if negative)
+      @param error - Training error to include (omitted if negative)
+  */
+  std::string json(int epoch=-1, float error=-1) const;
+
+  /// Print a summary.
+  void   print() const;
+
+  /// Time in seconds since an arbitrary origin (0 if JNNOSTATS is
+  /// defined).
+  static double clock()
+  {
+#ifdef JNNOSTATS
+    return 0;
+#else
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+#endif
+  }
+
+ private:
+  friend class Jetnet;
+  friend class BackProp;
+
+  int    _epochs;
+  double _patterns;
+  double _seconds;
+  double _time[kNPHASES];
+  long   _updates;
+  long   _iterations;
+  long   _searches;
+  int    _longest;
+  int    _restarts;
+  int    _warnings;
+  int    _lastWarning;
+};
+
+#endif
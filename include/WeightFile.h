@@ -0,0 +1,113 @@
+#ifndef WEIGHTFILE_H
+#define WEIGHTFILE_H
+//-----------------------------------------------------------------------------
+// File: WeightFile.h
+// Purpose: Memory-mapped binary network weight files
+// Created: 18-Oct-2026
+//-----------------------------------------------------------------------------
+#include <string>
+#include <vector>
+#include <cstddef>
+
+/** Read-only, memory-mapped binary weight file.
+    The file holds the same information as an MLPfit weight file
+    (extension .net): the number of nodes per layer, the weights, and
+    the name, mean and scale of each input variable, together with the
+    type of output node. It is mapped into memory rather than parsed,
+    and its contents are verified against a checksum. The conventional
+    extension is .jnw.
+    <p>
+    File layout (all numbers in native byte order):
+    <table>
+    <tr align=left><td>char[8]</td> <td>magic "JNWGTS\\0\\0"</td></tr>
+    <tr align=left><td>uint32</td>  <td>format version (1)</td></tr>
+    <tr align=left><td>uint32</td>  <td>output type (0 sigmoid, 1 linear)</td></tr>
+    <tr align=left><td>uint32</td>  <td>number of layers</td></tr>
+    <tr align=left><td>uint32</td>  <td>number of inputs</td></tr>
+    <tr align=left><td>uint64</td>  <td>number of weights</td></tr>
+    <tr align=left><td>uint64</td>  <td>offset of weights</td></tr>
+    <tr align=left><td>uint64</td>  <td>FNV-1a checksum of the rest of
+                                  the file</td></tr>
+    <tr align=left><td></td>  <td>int32 nodes per layer</td></tr>
+    <tr align=left><td></td>  <td>float32 mean, then float32 scale, of
+                                  each input</td></tr>
+    <tr align=left><td></td>  <td>for each input: uint32 length of
+                                  name, followed by the name</td></tr>
+    <tr align=left><td></td>  <td>float64 weights in MLPfit ordering,
+                                  starting on a 64-byte boundary</td></tr>
+    </table>
+*/
+class WeightFile
+{
+ public:
+
+  /// Map file into memory. Check good() before use.
+  WeightFile(std::string filename);
+
+  ///
+  ~WeightFile();
+
+  /// False if the file could not be opened, is not a weight file or
+  /// is corrupt.
+  bool   good() const { return _base != 0; }
+
+  /// Number of nodes per layer.
+  const std::vector<int>& nodes() const { return _nodes; }
+
+  /// Number of weights.
+  size_t size() const { return _nweights; }
+
+  /// Return pointer to first weight.
+  const double* weights() const;
+
+  /// Names of input variables.
+  const std::vector<std::string>& names() const { return _names; }
+
+  /// Mean of each input variable.
+  const std::vector<float>& mean() const { return _mean; }
+
+  /// Scale of each input variable.
+  const std::vector<float>& sigma() const { return _sigma; }
+
+  /// 0 for sigmoid output, 1 for linear output.
+  int    outputType() const { return _outputType; }
+
+  /** Write a network to a binary weight file.
+      @return 0 on success, -1 if the file cannot be opened, -2 if
+      the numbers of weights or inputs do not match the nodes.
+  */
+  static int write(std::string binaryfile,
+		   const std::vector<int>&         nodes,
+		   const std::vector<double>&      weight,
+		   const std::vector<std::string>& var,
+		   const std::vector<float>&       mean,
+		   const std::vector<float>&       sigma,
+		   int outputType);
+
+  /** Convert an MLPfit weight file (extension .net) to binary format.
+      @return 0 on success, -1 if a file cannot be opened, -2 if the
+      weight file is inconsistent.
+  */
+  static int convert(std::string netfile, std::string binaryfile);
+
+  /** Convert a binary weight file to MLPfit format.
+      @return 0 on success, -1 if a file cannot be opened or read.
+  */
+  static int dump(std::string binaryfile, std::string netfile);
+
+ private:
+  std::vector<int>         _nodes;
+  std::vector<std::string> _names;
+  std::vector<float>       _mean;
+  std::vector<float>       _sigma;
+  int    _outputType;
+  size_t _nweights;
+  size_t _offset;
+  size_t _length;
+  char*  _base;
+
+  WeightFile(const WeightFile&);
+  WeightFile& operator=(const WeightFile&);
+};
+
+#endif
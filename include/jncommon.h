@@ -0,0 +1,126 @@
+#ifndef JNCOMMON_H
+#define JNCOMMON_H
+//-----------------------------------------------------------------------------
+// File: jncommon.h
+// Purpose: Declare JETNET 3.4 routines and common blocks
+// Created: 18-Oct-2026
+//-----------------------------------------------------------------------------
+
+// External functions
+
+extern "C" 
+{
+  void jninit_(void);
+  void jntral_(void);
+  void jntest_(void);
+
+  void jnreadweights_   (const char* filename, int* status, int);
+  void jndumpparams_    (void);
+  void jndumpweights_   (const char* filename, int);
+  void jndumpweightsmlp_(const char* filename, int);
+  void jnwritename_     (const char* filename, float& mean, float& sigma, int);
+  void jncloseweights_  (int& outtype);
+}
+
+//  Declare JETNET common blocks
+
+const int MAXI = 50000;
+const int MAXO = 1000;
+const int MAXV = 2000;
+const int MAXM = 150000;
+
+extern struct jndat1 
+{
+  int   mstjn[40];
+  float parjn[40];
+  int   mstjm[20];
+  float parjm[20];
+  float oin[MAXI];
+  float out[MAXO];
+  int   mxndjm;
+} jndat1_; // Note: all FORTRAN names are postfixed with an "_"
+
+extern struct jndat2
+{
+  float  tinv[10];
+  int    igfn[10];
+  float  etal[10];
+  float  widl[10];
+  float  satm[10];
+} jndat2_; // Note: all FORTRAN names are postfixed with an "_"
+
+extern struct jnint1
+{
+  float  o[MAXV];
+  float  a[MAXV];
+  float  d[MAXV];
+  float  t[MAXV];
+  float  dt[MAXV];
+  float  w[MAXM];
+  float  dw[MAXM];
+  int    nself[MAXM];
+  int    ntself[MAXV];
+  float  g[MAXM+MAXV];
+  float  odw[MAXM];
+  float  odt[MAXV];
+  float  etav[MAXM+MAXV];
+} jnint1_; // Note: all FORTRAN names are postfixed with an "_"
+
+extern struct jnint2
+{
+  int    m[11];
+  int    mv0[11];
+  int    mm0[11];
+  int    ng[10];
+  int    nl;
+  int    ipott;
+  float  er1;
+  float  er2;
+  float  sm[10];
+  int    icpon;
+} jnint2_; // Note: all FORTRAN names are postfixed with an "_"
+
+extern struct jnint4
+{
+  int    ilinon;
+  int    nc;
+  float  g2;
+  int    nit;
+  float  errln[4];
+  float  derrln;
+  float  stepln[4];
+  float  stepmn;
+  float  errmn;
+  int    ieval;
+  int    isucc;
+  int    icurve;
+  int    nsc;
+  float  gvec2;
+} jnint4_; // Note: all FORTRAN names are postfixed with an "_"
+
+extern struct jnint3
+{
+  int    nxin;
+  int    nyin;
+  int    nxrf;
+  int    nyrf;
+  int    nxhrf;
+  int    nyhrf;
+  int    nhrf;
+  int    nrfw;
+  int    nhprf;
+} jnint3_; // Note: all FORTRAN names are postfixed with an "_"
+
+extern struct jndatr
+{
+  int    mrjn[5];
+  float  rrjn[100];
+} jndatr_; // Note: all FORTRAN names are postfixed with an "_"
+
+extern struct jngaus
+{
+  int    iset;
+  float  gasdev;
+} jngaus_; // Note: all FORTRAN names are postfixed with an "_"
+
+#endif
@@ -31,7 +31,10 @@ int   nncompute(std::vector<int>&    nodes,
 		std::vector<float>&  inp, 
 		std::vector<float>&  out, int outputType);
 
-// Write out C++ function
+// Write out C++ function. If table is positive, the transfer functions
+// are interpolated in a table of tanh with that many intervals (see
+// ActivationTable), written in the file, instead of sigmoid and
+// sigmoidout
 
 int   nnsaveCPP(std::string title1, 
 		std::string title2,
@@ -43,16 +46,27 @@ int   nnsaveCPP(std::string title1,
 		std::vector<std::string>& var, 
 		std::vector<float>&       mean,
 		std::vector<float>&       sigma,
-		int outputType);
+		int outputType,
+		bool arrays=false,
+		int table=0);
 
 float nnpower(std::vector<int>& s, std::vector<int>& b);
 
+/// Same as above, for histograms of weighted patterns.
+float nnpower(std::vector<double>& s, std::vector<double>& b);
+
 void  nnefficiencies(std::vector<int>& v, std::vector<float>& e);
 
+///
+void  nnefficiencies(std::vector<double>& v, std::vector<float>& e);
+
 float nnarea(std::vector<float>& ex, std::vector<float>& ey);
 
 float nndivergence(std::vector<int>& s, std::vector<int>& b);
 
+///
+float nndivergence(std::vector<double>& s, std::vector<double>& b);
+
 #endif
 
 
@@ -0,0 +1,87 @@
+#ifndef NNKERNEL_H
+#define NNKERNEL_H
+///////////////////////////////////////////////////////////////
+// File: nnkernel.h
+// Purpose: Native forward kernels used for batched network
+//          evaluation. Patterns are processed in blocks of
+//          NNBLOCK, stored node-major, so that every loop runs
+//          over the patterns of a block and vectorizes.
+// Created: 18-Oct-2026
+///////////////////////////////////////////////////////////////
+
+#include <vector>
+
+class ActivationTable;
+
+// Number of patterns processed together by the block kernels
+const int NNBLOCK = 64;
+
+// Transfer function codes (same as JETNET's MSTJN(3)/IGFN)
+//   1 -> g(x)=1/(1+exp(-2x))
+//   2 -> g(x)=tanh(x)
+//   4 -> g(x)=x
+//   5 -> g(x)=1/(1+exp(-2x)) (entropy error output)
+// Callers accept no other code (see BackProp::supported and
+// CompiledNetwork); the kernels assert on any other.
+
+// Fast tanh. Maximum absolute error w.r.t. std::tanh is below 5e-7.
+
+float nntanh(float x);
+
+// The transfer functions are computed with nntanh. Maximum absolute
+// error w.r.t. the exact functions (double precision):
+//   1, 5  -> 3e-7
+//   2     -> 5e-7
+//   4     -> 0
+// and 8e-7 for the derivatives.
+// The loops are compiled for AVX-512, AVX2 and the baseline
+// instruction set; the widest one supported by the processor is
+// selected at run time (setting JETNET_NOSIMD forces the baseline).
+// All versions give bit-for-bit the same results.
+
+// Name of the instruction set selected at run time
+
+const char* nnisa();
+
+// Apply transfer function to n contiguous values (in place). This is
+// the inference mode: no derivatives are computed.
+
+void  nnactivate(int type, float* x, int n);
+
+// Apply transfer function to n contiguous values (in place) and store
+// the derivatives in dx, as GJN does in GPJN (without PARJN(23)). For
+// type 5, the derivative is 2, as in GJN (entropy error output).
+
+void  nnactivate(int type, float* x, float* dx, int n);
+
+// Apply transfer function to n contiguous values (in place), with
+// tanh interpolated linearly in a table of its values at intervals+1
+// equidistant points of [-8, 8], and +/-1 beyond (see ActivationTable).
+
+void  nnactivate(int type, const float* table, int intervals, 
+		 float* x, int n);
+
+// Compute one layer for a block of NNBLOCK patterns.
+// w holds, for each of the nout nodes, the threshold followed by
+// the nin weights (MLPfit ordering). y is the node-major input
+// block (nin x NNBLOCK) and x the node-major output block
+// (nout x NNBLOCK).
+
+void  nnlayer(int nin, int nout, const float* w, const float* y, float* x);
+
+// Feed a block of NNBLOCK patterns through a network.
+// nodes  - number of nodes per layer
+// weight - all layers, MLPfit ordering
+// types  - transfer function code per layer (excluding input layer)
+// work   - scratch space of at least 2 * max(nodes) * NNBLOCK floats
+// inp    - node-major input block; the output block is returned
+// table  - if given, the transfer functions are interpolated in it
+
+float* nnforward(const std::vector<int>&   nodes,
+		 const std::vector<float>& weight,
+		 const std::vector<int>&   types,
+		 const float* inp,
+		 float* work,
+		 const ActivationTable* table=0);
+
+#endif
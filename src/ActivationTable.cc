@@ -0,0 +1,89 @@
+//-----------------------------------------------------------------------------
+// File: ActivationTable.cc
+// Purpose: Shared interpolation table of tanh for low-latency scoring
+// Created: 18-Oct-2026
+//-----------------------------------------------------------------------------
+#include <cmath>
+#include <map>
+#include <mutex>
+
+#include "nnkernel.h"
+#include "ActivationTable.h"
+
+using namespace std;
+
+namespace {
+  const int MININTERVALS = 64;
+  const int MAXINTERVALS = 65536;
+
+  // Largest |tanh''(x)|, which bounds the interpolation error:
+  // h^2/8 * 4/(3 sqrt(3)) for intervals of width h
+  const double CURVATURE = 4 / (3 * sqrt(3.0));
+
+  // Tables by number of intervals. They live until the end of the
+  // process, so the pointers handed out stay valid.
+  mutex& registryLock()
+  {
+    static mutex lock;
+    return lock;
+  }
+
+  map<int, const ActivationTable*>& registry()
+  {
+    static map<int, const ActivationTable*> tables;
+    return tables;
+  }
+};
+
+ActivationTable::ActivationTable(int intervals)
+  : _intervals(intervals),
+    _scale((float)intervals / (2 * RANGE)),
+    _top((float)intervals),
+    _maxError(0),
+    _value(intervals + 1)
+{
+  double h = 2.0 * RANGE / intervals;
+  for (int k = 0; k <= intervals; k++)
+    _value[k] = (float)std::tanh(-RANGE + k * h);
+
+  // Measure the error, at several points per interval and beyond
+  // the tabulated range
+
+  const int NSTEP = 8;
+  for (int k = 0; k < intervals * NSTEP; k++)
+    {
+      double x = -RANGE + (k + 0.5) * h / NSTEP;
+      _maxError = max(_maxError, fabs(tanh((float)x) - std::tanh(x)));
+    }
+  _maxError = max(_maxError, 1 - std::tanh((double)RANGE));
+}
+
+const ActivationTable* ActivationTable::shared(int intervals)
+{
+  int n = MININTERVALS;
+  while ( n < intervals && n < MAXINTERVALS ) n *= 2;
+
+  lock_guard<mutex> guard(registryLock());
+  const ActivationTable*& table = registry()[n];
+  if ( table == 0 ) table = new ActivationTable(n);
+  return table;
+}
+
+int ActivationTable::intervalsFor(double maxError)
+{
+  // Half of the error for interpolation; the rest covers rounding
+  // to float and the ends of the range
+  double e = max(maxError, 1e-6) / 2;
+  double h = sqrt(8 * e / CURVATURE);
+  return (int)ceil(2 * RANGE / h);
+}
+
+const ActivationTable* ActivationTable::forError(double maxError)
+{
+  return shared(intervalsFor(maxError));
+}
+
+void ActivationTable::apply(int type, float* x, int n) const
+{
+  nnactivate(type, _value.data(), _intervals, x, n);
+}
@@ -0,0 +1,67 @@
+//-----------------------------------------------------------------------------
+// File: AliasTable.cc
+// Purpose: Walker's alias table for drawing indices in proportion to weights
+// Created: 18-Oct-2026
+//-----------------------------------------------------------------------------
+#include "AliasTable.h"
+
+using namespace std;
+
+bool AliasTable::build(const float* weights, size_t n)
+{
+  _prob.clear();
+  _alias.clear();
+
+  double sumw = 0;
+  for (size_t i = 0; i < n; i++) 
+    if ( weights[i] > 0 ) sumw += weights[i];
+  if ( n == 0 || !(sumw > 0) ) return false;
+
+  // Scale the weights to a mean of 1, then split the columns into
+  // those below (small) and above (large) the mean
+
+  vector<double> p(n);
+  vector<int> small, large;
+  small.reserve(n);
+  large.reserve(n);
+  for (size_t i = 0; i < n; i++)
+    {
+      p[i] = weights[i] > 0 ? weights[i] * n / sumw : 0;
+      if ( p[i] < 1 )
+	small.push_back(i);
+      else
+	large.push_back(i);
+    }
+
+  // Fill each small column up to 1 with part of a large one
+
+  _prob.resize(n);
+  _alias.resize(n);
+  while ( small.size() > 0 && large.size() > 0 )
+    {
+      int s = small.back(); small.pop_back();
+      int l = large.back();
+      _prob[s]  = p[s];
+      _alias[s] = l;
+      p[l] -= 1 - p[s];
+      if ( p[l] < 1 )
+	{
+	  large.pop_back();
+	  small.push_back(l);
+	}
+    }
+
+  // What is left is 1, up to rounding
+
+  for (size_t i = 0; i < large.size(); i++) 
+    {
+      _prob[large[i]]  = 1;
+      _alias[large[i]] = large[i];
+    }
+  for (size_t i = 0; i < small.size(); i++)
+    {
+      _prob[small[i]]  = 1;
+      _alias[small[i]] = small[i];
+    }
+  return true;
+}
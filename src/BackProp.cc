@@ -0,0 +1,523 @@
+//-----------------------------------------------------------------------------
+// File: BackProp.cc
+// Purpose: Native back-propagation engine for JETNET methods 0, 1 and 2
+// Created: 18-Oct-2026
+//-----------------------------------------------------------------------------
+#include <cmath>
+#include <algorithm>
+
+#include "JetnetContext.h"
+#include "nnkernel.h"
+#include "ThreadPool.h"
+#include "PatternStore.h"
+#include "NetworkState.h"
+#include "TrainingStats.h"
+#include "BackProp.h"
+
+using namespace std;
+
+// Sums over the patterns of a slice are done in 8 partial sums, which
+// vectorize, unless the slice is short. The order of summation depends
+// only on the slice size.
+
+namespace {
+  const int LANES = 8;
+
+  // Fewest patterns in a slice, when an update is cut into one slice
+  // per thread
+  const int MINSLICE = 4;
+
+  // Least work of an update, in multiply-adds of the forward pass,
+  // for which waking the threads pays off; below it the slices run on
+  // the calling thread, with the same results
+  const double PARALLELWORK = 16384;
+
+  inline float sum(const float* __restrict__ x, int n)
+  {
+    if ( n < LANES )
+      {
+	float s = 0;
+	for (int b = 0; b < n; b++) s += x[b];
+	return s;
+      }
+    float acc[LANES] = {0};
+    int b = 0;
+    for (; b + LANES <= n; b += LANES)
+      for (int k = 0; k < LANES; k++) acc[k] += x[b+k];
+    for (int k = 0; b < n; b++, k++) acc[k] += x[b];
+    return ((acc[0] + acc[1]) + (acc[2] + acc[3])) +
+           ((acc[4] + acc[5]) + (acc[6] + acc[7]));
+  }
+
+  inline float dot(const float* __restrict__ x,
+		   const float* __restrict__ y, int n)
+  {
+    if ( n < LANES )
+      {
+	float s = 0;
+	for (int b = 0; b < n; b++) s += x[b] * y[b];
+	return s;
+      }
+    float acc[LANES] = {0};
+    int b = 0;
+    for (; b + LANES <= n; b += LANES)
+      for (int k = 0; k < LANES; k++) acc[k] += x[b+k] * y[b+k];
+    for (int k = 0; b < n; b++, k++) acc[k] += x[b] * y[b];
+    return ((acc[0] + acc[1]) + (acc[2] + acc[3])) +
+           ((acc[4] + acc[5]) + (acc[6] + acc[7]));
+  }
+};
+
+BackProp::BackProp()
+  : _jn(0),
+    _net(0),
+    _wscale(1),
+    _rows(0),
+    _worksize(0)
+{}
+
+bool BackProp::supported(const JetnetContext& jn)
+{
+  const int*    mstjn = jn.mstjn;
+  const jnint2& int2  = jn.int2;
+
+  if ( mstjn[7] == 0 || mstjn[8] <= 0 ) return false; // Not initialized
+  if ( mstjn[4] < 0  || mstjn[4] > 2 )  return false; // Method
+  if ( mstjn[3] != 0 && mstjn[3] != 1 ) return false; // Error measure
+  if ( mstjn[21] != 0 ) return false;                 // Saturation control
+  if ( mstjn[22] != 0 ) return false;                 // Receptive fields
+  if ( int2.icpon != 0 ) return false;                // Fixed precision
+  if ( int2.m[int2.nl] != 1 ) return false;           // Single output
+
+  for (int l = 0; l < int2.nl; l++)
+    {
+      int g = int2.ng[l];
+      if ( g != 1 && g != 2 && g != 4 && g != 5 ) return false;
+    }
+  return true;
+}
+
+// Inverse temperature of layer l (1,...,nl), as in JNFEED
+
+float BackProp::_beta(int l) const
+{
+  return _jn->dat2.tinv[l-1] == 0
+    ? _jn->parjn[2]
+    : fabs(_jn->dat2.tinv[l-1]);
+}
+
+// Learning rate of layer l, per pattern, as in JNTRAL
+
+float BackProp::_eta(int l) const
+{
+  float ppu = (float)_jn->mstjn[1];
+  return _jn->dat2.etal[l-1] == 0
+    ? _jn->parjn[0] / ppu
+    : _jn->dat2.etal[l-1] / ppu;
+}
+
+void BackProp::train(JetnetContext& jn,
+		     NetworkState& net,
+		     const PatternStore& input,
+		     const vector<float>& mean,
+		     const vector<float>& sigma,
+		     jtn::ThreadPool* pool,
+		     float wscale,
+		     const vector<int>* rows,
+		     TrainingStats* stats)
+{
+  if ( input.size() == 0 ) return;
+  _jn  = &jn;
+  _net = &net;
+  _wscale = wscale;
+  _rows   = rows;
+
+  // Scratch space of a thread: the input block, followed by the
+  // outputs, derivatives and deltas of each layer
+
+  _off = vector<int>(net.nl + 1, 0);
+  _off[1] = net.m[0] * NNBLOCK;
+  for (int l = 2; l <= net.nl; l++) 
+    _off[l] = _off[l-1] + 3 * net.m[l-1] * NNBLOCK;
+  _worksize = _off[net.nl] + 3 * net.m[net.nl] * NNBLOCK;
+
+  int nthreads = pool ? pool->size() : 1;
+  _work.resize(nthreads);
+  for (int i = 0; i < nthreads; i++) _work[i].resize(_worksize);
+
+  int*   mstjn = _jn->mstjn;
+  int    ppu   = mstjn[1];
+  size_t npat  = rows ? rows->size() : input.size();
+  size_t first = 0;
+  while ( first < npat )
+    {
+      // Patterns left before the next update (JNTRAL updates
+      // whenever MSTJN(7) is a multiple of MSTJN(2))
+
+      int n = ppu - mstjn[6] % ppu;
+      if ( (size_t)n > npat - first ) n = npat - first;
+
+      // One slice per thread, of at most NNBLOCK patterns
+
+      int size   = min(NNBLOCK, max(MINSLICE, (n + nthreads - 1) / nthreads));
+      int nslice = (n + size - 1) / size;
+      if ( (int)_grad.size() < nslice ) _grad.resize(nslice);
+      for (int s = 0; s < nslice; s++) _grad[s].resize(net.nw + net.nt);
+      _err.resize(n);
+      _time.resize(2 * nslice);
+
+      auto task = [&](int s, int thread)
+	{
+	  int offset = s * size;
+	  _slice(input, first + offset, min(size, n - offset),
+		 mean, sigma,
+		 &_work[thread][0], &_grad[s][0], &_err[offset], &_time[2*s]);
+	};
+
+      if ( pool != 0 && nslice > 1 && (double)n * net.nw >= PARALLELWORK )
+	pool->run(nslice, task);
+      else
+	for (int s = 0; s < nslice; s++) task(s, 0);
+
+      // Sum gradients in slice order
+
+      for (int s = 0; s < nslice; s++)
+	{
+	  const float* g = &_grad[s][0];
+	  for (int k = 0; k < net.nw; k++) net.dw[k] += g[k];
+	  for (int k = 0; k < net.nt; k++) net.dt[k] += g[net.nw + k];
+	}
+
+      // Sum errors in pattern order
+
+      for (int p = 0; p < n; p++)
+	{
+	  _jn->parjn[6] = _err[p];
+	  _jn->int2.er1 += _err[p];
+	  _jn->int2.er2 += _err[p];
+	}
+
+      mstjn[6] += n;
+      first    += n;
+      if ( mstjn[6] % ppu == 0 ) 
+	{
+	  double t0 = TrainingStats::clock();
+	  _update();
+	  if ( stats )
+	    {
+	      stats->_time[TrainingStats::kUPDATE] += TrainingStats::clock() - t0;
+	      stats->_updates++;
+	    }
+	}
+
+      if ( stats )
+	for (int s = 0; s < nslice; s++)
+	  {
+	    stats->_time[TrainingStats::kFORWARD]  += _time[2*s];
+	    stats->_time[TrainingStats::kBACKWARD] += _time[2*s+1];
+	  }
+    }
+}
+
+// Forward and backward pass for n (<= NNBLOCK) patterns, starting at
+// pattern first (of the rows, if given). Writes the gradient of the weights and thresholds
+// to grad and the error of each pattern to err, and the times of
+// the forward and backward passes to time[0] and time[1].
+
+void BackProp::_slice(const PatternStore& input, size_t first, int n,
+		      const vector<float>& mean,
+		      const vector<float>& sigma,
+		      float* work, float* grad, float* err, double* time)
+{
+  double t0 = TrainingStats::clock();
+  const NetworkState& net = *_net;
+  const int B = NNBLOCK;
+  const float p23 = _jn->parjn[22];
+
+  // Within each block, nodes are n values apart
+
+  float* in = work;
+  bool normalize = !mean.empty();
+  for (int b = 0; b < n; b++)
+    {
+      const float* row = input.row(_row(first + b));
+      if ( normalize )
+	for (int j = 0; j < net.m[0]; j++)
+	  in[j * n + b] = (row[j] - mean[j]) / sigma[j];
+      else
+	for (int j = 0; j < net.m[0]; j++) in[j * n + b] = row[j];
+    }
+
+  // Rows visited in random order are scattered in memory: fetch those
+  // of the next slice while this one is being computed
+
+  if ( _rows )
+    {
+      size_t last = min(first + 2 * n, _rows->size());
+      size_t size = input.columns() * sizeof(float);
+      for (size_t i = first + n; i < last; i++)
+	{
+	  // Packed rows may straddle cache lines: fetch the last too
+	  const char* row = (const char*)input.row((*_rows)[i]);
+	  for (size_t k = 0; k < size; k += 64) __builtin_prefetch(row + k);
+	  __builtin_prefetch(row + size - 1);
+	}
+    }
+
+  // Forward pass (same order of summation as JNFEED)
+
+  const float* y = in;
+  for (int l = 1; l <= net.nl; l++)
+    {
+      float* o  = work + _off[l];
+      float* gp = o + net.m[l] * B;
+      float beta = _beta(l);
+      const float* w = &net.w[net.mm0[l-1]];
+      const float* t = &net.t[net.mv0[l-1]];
+
+      for (int i = 0; i < net.m[l]; i++)
+	{
+	  float* __restrict__ oi = o + i * n;
+	  for (int b = 0; b < n; b++) oi[b] = t[i];
+	  for (int j = 0; j < net.m[l-1]; j++)
+	    {
+	      float wij = w[j * net.m[l] + i];
+	      const float* __restrict__ yj = y + j * n;
+	      for (int b = 0; b < n; b++) oi[b] += wij * yj[b];
+	    }
+	  for (int b = 0; b < n; b++) oi[b] *= beta;
+	}
+      // Transfer function and its derivative (GPJN)
+
+      nnactivate(net.ng[l-1], o, gp, net.m[l] * n);
+      if ( p23 != 0 && (net.ng[l-1] == 1 || net.ng[l-1] == 2) )
+	for (int i = 0; i < net.m[l] * n; i++) gp[i] += p23;
+
+      y = o;
+    }
+  double t1 = TrainingStats::clock();
+
+  // Error and delta of output node (ERRJN and JNDELT)
+
+  {
+    float* o  = work + _off[net.nl];
+    float* gp = o  + net.m[net.nl] * B;
+    float* d  = gp + net.m[net.nl] * B;
+    for (int b = 0; b < n; b++)
+      {
+	float target = input.target(_row(first + b));
+	float diff = target - o[b];
+	if ( _jn->mstjn[3] == 0 )
+	  err[b] = 0.5f * diff * diff;
+	else
+	  err[b] = -(target * log(o[b]) + (1 - target) * log(1 - o[b]));
+	d[b] = diff * gp[b];
+      }
+
+    // Pattern weights scale the error and the gradient
+
+    if ( _wscale > 0 && input.weighted() )
+      for (int b = 0; b < n; b++)
+	{
+	  float w = _wscale * input.weight(_row(first + b));
+	  err[b] *= w;
+	  d[b]   *= w;
+	}
+  }
+
+  // Deltas of hidden nodes
+
+  for (int l = net.nl - 1; l >= 1; l--)
+    {
+      float* gp = work + _off[l] + net.m[l] * B;
+      float* d  = gp + net.m[l] * B;
+      const float* dn = work + _off[l+1] + 2 * net.m[l+1] * B;
+      const float* w  = &net.w[net.mm0[l]];
+      for (int j = 0; j < net.m[l]; j++)
+	{
+	  float* __restrict__ dj = d + j * n;
+	  fill(dj, dj + n, 0.0f);
+	  for (int i = 0; i < net.m[l+1]; i++)
+	    {
+	      float wij = w[j * net.m[l+1] + i];
+	      const float* __restrict__ di = dn + i * n;
+	      for (int b = 0; b < n; b++) dj[b] += di[b] * wij;
+	    }
+	  const float* __restrict__ gj = gp + j * n;
+	  for (int b = 0; b < n; b++) dj[b] *= gj[b];
+	}
+    }
+
+  // Gradient of weights and thresholds
+
+  y = in;
+  for (int l = 1; l <= net.nl; l++)
+    {
+      const float* o = work + _off[l];
+      const float* d = o + 2 * net.m[l] * B;
+      float* gw = grad + net.mm0[l-1];
+      float* gt = grad + net.nw + net.mv0[l-1];
+      for (int i = 0; i < net.m[l]; i++)
+	{
+	  const float* di = d + i * n;
+	  gt[i] = sum(di, n);
+	  for (int j = 0; j < net.m[l-1]; j++)
+	    gw[j * net.m[l] + i] = dot(di, y + j * n, n);
+	}
+      y = o;
+    }
+  double t2 = TrainingStats::clock();
+  time[0] = t1 - t0;
+  time[1] = t2 - t1;
+}
+
+// Update weights and thresholds, as JNTRAL does every MSTJN(2) patterns
+
+void BackProp::_update()
+{
+  NetworkState& net = *_net;
+  int*   mstjn = _jn->mstjn;
+  float* parjn = _jn->parjn;
+  float  ppu   = (float)mstjn[1];
+
+  parjn[7] = _jn->int2.er1 / ppu;
+  _jn->int2.er1 = 0;
+
+  if ( mstjn[20] > 0 )
+    {
+      // Include pruning factors
+
+      float beta = 1;
+      float w0sq = parjn[17] * parjn[17];
+      for (int l = net.nl; l >= 1; l--)
+	{
+	  beta *= _beta(l);
+	  float factor = 2.0f * ppu * parjn[13] * w0sq / beta;
+	  for (int i = net.mm0[l-1]; i < net.mm0[l]; i++)
+	    {
+	      float q = w0sq + net.w[i] * net.w[i];
+	      net.dw[i] -= factor * net.w[i] / (q * q);
+	    }
+	  for (int i = net.mv0[l-1]; i < net.mv0[l]; i++)
+	    {
+	      float q = w0sq + net.t[i] * net.t[i];
+	      net.dt[i] -= factor * net.t[i] / (q * q);
+	    }
+	}
+    }
+
+  float decay = parjn[4];
+  float alpha = parjn[1];
+  if ( mstjn[4] == 1 )
+    {
+      // Manhattan updating
+
+      for (int l = 1; l <= net.nl; l++)
+	{
+	  float eta = _eta(l);
+	  for (int i = net.mm0[l-1]; i < net.mm0[l]; i++)
+	    {
+	      float step = net.dw[i] >= 0 ? eta : -eta;
+	      float self = (float)net.nself[i];
+	      net.w[i]  = (1 - decay * self) * net.w[i] + step * self;
+	      net.dw[i] = net.dw[i] * alpha;
+	    }
+	  for (int i = net.mv0[l-1]; i < net.mv0[l]; i++)
+	    {
+	      float step = net.dt[i] >= 0 ? eta : -eta;
+	      float self = (float)net.ntself[i];
+	      net.t[i]  = (1 - decay * self) * net.t[i] + step * self;
+	      net.dt[i] = net.dt[i] * alpha;
+	    }
+	}
+    }
+  else
+    {
+      // Normal (0) and Langevin (2) updating; the noise is drawn
+      // in the same order as in JNTRAL
+
+      bool  langevin = mstjn[4] == 2;
+      float noise = parjn[5];
+      float beta  = 1;
+      for (int l = net.nl; l >= 1; l--)
+	{
+	  beta *= _beta(l);
+	  float eta = _eta(l) * beta;
+	  for (int i = net.mm0[l-1]; i < net.mm0[l]; i++)
+	    {
+	      float self = (float)net.nself[i];
+	      net.w[i] = (1 - decay * self) * net.w[i] + net.dw[i] * self * eta;
+	      if ( langevin )
+		net.w[i] += _jn->gausjn() * noise;
+	      net.dw[i] = net.dw[i] * alpha;
+	    }
+	  for (int i = net.mv0[l-1]; i < net.mv0[l]; i++)
+	    {
+	      float self = (float)net.ntself[i];
+	      net.t[i] = (1 - decay * self) * net.t[i] + net.dt[i] * self * eta;
+	      if ( langevin )
+		net.t[i] += _jn->gausjn() * noise;
+	      net.dt[i] = net.dt[i] * alpha;
+	    }
+	}
+    }
+
+  _jn->int4.ilinon = 0;
+  _jn->int4.nc     = 0;
+  _jn->int4.nsc    = 0;
+
+  // Scale temperature
+
+  if ( parjn[12] != 1 )
+    {
+      float scale = pow(parjn[12], 1.0f / (float)mstjn[8]);
+      parjn[2] /= scale;
+      for (int l = 0; l < net.nl; l++) _jn->dat2.tinv[l] /= scale;
+    }
+
+  if ( mstjn[6] % (mstjn[1] * mstjn[8]) == 0 ) _epoch();
+}
+
+// Update parameters, as JNTRAL does at the end of each epoch
+
+void BackProp::_epoch()
+{
+  int*   mstjn = _jn->mstjn;
+  float* parjn = _jn->parjn;
+
+  float olde = parjn[8];
+  parjn[8] = _jn->int2.er2 / (float)(mstjn[1] * mstjn[8]);
+  _jn->int2.er2 = 0;
+
+  if ( mstjn[20] > 0 )
+    {
+      // Update pruning parameters
+
+      parjn[9] = parjn[15] * parjn[9] + (1 - parjn[15]) * parjn[8];
+      if ( parjn[8] < olde || parjn[8] < parjn[18] )
+	parjn[13] += parjn[14];
+      else if ( parjn[8] < parjn[9] )
+	parjn[13] -= parjn[14];
+      else
+	parjn[13] *= parjn[16];
+    }
+
+  // Scale learning rate
+
+  float factor = 1;
+  if ( parjn[10] > 0 )
+    factor = parjn[8] >= olde ? parjn[10] : 1 + 0.1f * (1 - parjn[10]);
+  else if ( parjn[10] < 0 )
+    factor = fabs(parjn[10]);
+
+  if ( parjn[10] != 0 )
+    {
+      parjn[0] *= factor;
+      for (int i = 0; i < 10; i++) _jn->dat2.etal[i] *= factor;
+    }
+
+  // Scale momentum and Langevin noise
+
+  parjn[1] *= parjn[11];
+  parjn[5] *= parjn[19];
+}
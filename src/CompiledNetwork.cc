@@ -0,0 +1,195 @@
+//-----------------------------------------------------------------------------
+// File: CompiledNetwork.cc
+// Purpose: Immutable, self-contained network function
+// Created: 18-Oct-2026
+//-----------------------------------------------------------------------------
+#include <algorithm>
+
+#include "network.h"
+#include "nnkernel.h"
+#include "ActivationTable.h"
+#include "WeightFile.h"
+#include "CompiledNetwork.h"
+
+using namespace std;
+
+// Largest layer evaluated with scratch space on the stack
+const int MAXSTACK = 256;
+
+CompiledNetwork::CompiledNetwork()
+  : _maxnodes(0),
+    _table(0)
+{}
+
+CompiledNetwork::CompiledNetwork(const vector<int>&    nodes,
+				 const vector<double>& weight,
+				 const vector<float>&  mean,
+				 const vector<float>&  sigma,
+				 int outputType)
+  : _maxnodes(0),
+    _table(0)
+{
+  _build(nodes, weight, mean, sigma, outputType);
+}
+
+CompiledNetwork::CompiledNetwork(string filename)
+  : _maxnodes(0),
+    _table(0)
+{
+  vector<int>    nodes;
+  vector<double> weight;
+  vector<string> var;
+  vector<float>  mean;
+  vector<float>  sigma;
+  int outputType = 0;
+
+  WeightFile wf(filename);
+  if ( wf.good() )
+    {
+      weight.assign(wf.weights(), wf.weights() + wf.size());
+      _build(wf.nodes(), weight, wf.mean(), wf.sigma(), wf.outputType());
+      return;
+    }
+
+  if ( nnload(filename, nodes, weight, var, mean, sigma, outputType) != 0 )
+    return;
+  _build(nodes, weight, mean, sigma, outputType);
+}
+
+CompiledNetwork::~CompiledNetwork() {}
+
+CompiledNetwork CompiledNetwork::tabulated(const ActivationTable* table) const
+{
+  CompiledNetwork net(*this);
+  net._table = table;
+  return net;
+}
+
+void CompiledNetwork::_build(const vector<int>&    nodes,
+			     const vector<double>& weight,
+			     const vector<float>&  mean,
+			     const vector<float>&  sigma,
+			     int outputType)
+{
+  _nodes = nodes;
+  _mean  = mean;
+  _sigma = sigma;
+  _weight.assign(weight.begin(), weight.end());
+
+  // Hidden nodes use tanh, the output node a sigmoid or the identity
+
+  _types.clear();
+  for (int l = 1; l < (int)_nodes.size()-1; l++) _types.push_back(2);
+  _types.push_back(outputType == 0 ? 1 : 4);
+
+  _maxnodes = *max_element(_nodes.begin(), _nodes.end());
+}
+
+template <class T>
+float CompiledNetwork::_evaluate(const T* inp) const
+{
+  if ( !good() ) return 0;
+
+  float  stack[2*MAXSTACK];
+  vector<float> heap;
+  float* buf = stack;
+  if ( _maxnodes > MAXSTACK )
+    {
+      heap.resize(2*_maxnodes);
+      buf = &heap[0];
+    }
+  float* y = buf;
+  float* x = buf + _maxnodes;
+
+  for (int j = 0; j < _nodes[0]; j++)
+    y[j] = (inp[j] - _mean[j]) / _sigma[j];
+
+  int k = 0;
+  for (int l = 1; l < (int)_nodes.size(); l++)
+    {
+      for (int i = 0; i < _nodes[l]; i++)
+	{
+	  float a = _weight[k++];
+	  for (int j = 0; j < _nodes[l-1]; j++)
+	    a += _weight[k++] * y[j];
+	  x[i] = a;
+	}
+      if ( _table )
+	_table->apply(_types[l-1], x, _nodes[l]);
+      else
+	nnactivate(_types[l-1], x, _nodes[l]);
+      swap(x, y);
+    }
+  return y[0];
+}
+
+float CompiledNetwork::evaluate(const float* inp) const
+{
+  return _evaluate(inp);
+}
+
+float CompiledNetwork::evaluate(const double* inp) const
+{
+  return _evaluate(inp);
+}
+
+float CompiledNetwork::evaluate(const vector<float>& inp) const
+{
+  return _evaluate(&inp[0]);
+}
+
+float CompiledNetwork::evaluate(const vector<double>& inp) const
+{
+  return _evaluate(&inp[0]);
+}
+
+void CompiledNetwork::evaluate(const float* rows, size_t n, size_t stride,
+			       float* out) const
+{
+  _batch(rows, n, stride, out, false);
+}
+
+void CompiledNetwork::evaluateNormalized(const float* rows, size_t n, 
+					 size_t stride, float* out) const
+{
+  _batch(rows, n, stride, out, true);
+}
+
+void CompiledNetwork::_batch(const float* rows, size_t n, size_t stride,
+			     float* out, bool normalized) const
+{
+  if ( !good() ) return;
+
+  // Per-thread scratch space, grown as needed
+
+  static thread_local vector<float> inp;
+  static thread_local vector<float> work;
+
+  int ninput = _nodes[0];
+  if ( inp.size()  < (size_t)(ninput * NNBLOCK) )
+    inp.resize(ninput * NNBLOCK);
+  if ( work.size() < (size_t)(2 * _maxnodes * NNBLOCK) )
+    work.resize(2 * _maxnodes * NNBLOCK);
+
+  for (size_t first = 0; first < n; first += NNBLOCK)
+    {
+      int nb = (int)min((size_t)NNBLOCK, n - first);
+
+      // Normalize block of patterns, stored node-major
+
+      for (int b = 0; b < nb; b++)
+	{
+	  const float* row = rows + (first + b) * stride;
+	  if ( normalized )
+	    for (int j = 0; j < ninput; j++) inp[j * NNBLOCK + b] = row[j];
+	  else
+	    for (int j = 0; j < ninput; j++)
+	      inp[j * NNBLOCK + b] = (row[j] - _mean[j]) / _sigma[j];
+	}
+
+      float* y = nnforward(_nodes, _weight, _types, &inp[0], &work[0], 
+			   _table);
+
+      copy(y, y + nb, out + first);
+    }
+}
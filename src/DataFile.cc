@@ -0,0 +1,212 @@
+//-----------------------------------------------------------------------------
+// File: DataFile.cc
+// Purpose: Memory-mapped binary columnar data files
+// Created: 18-Oct-2026
+//-----------------------------------------------------------------------------
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fstream>
+#include <sstream>
+
+#include "DataFile.h"
+
+using namespace std;
+
+namespace {
+  const char   MAGIC[8] = {'J','N','D','A','T','A',0,0};
+  const uint32_t VERSION = 1;
+  const size_t ALIGN = 64;
+
+  size_t align(size_t n) { return ((n + ALIGN - 1) / ALIGN) * ALIGN; }
+
+  struct Header
+  {
+    char     magic[8];
+    uint32_t version;
+    uint32_t ncolumns;
+    uint64_t nrows;
+    uint64_t offset;
+    uint64_t colsize;
+  };
+
+  // Check that the columns of a truncated or corrupt file lie within
+  // its length, without overflowing in the products
+  bool valid(const Header& h, size_t length)
+  {
+    if ( h.offset < sizeof(Header) || h.offset > length ) return false;
+    if ( h.nrows > h.colsize / sizeof(float) ) return false;
+    if ( h.ncolumns > 0 && h.colsize > (length - h.offset) / h.ncolumns )
+      return false;
+    return true;
+  }
+};
+
+DataFile::DataFile(string filename)
+  : _nrows(0),
+    _offset(0),
+    _colsize(0),
+    _length(0),
+    _base(0)
+{
+  int fd = open(filename.c_str(), O_RDONLY);
+  if ( fd < 0 ) return;
+
+  struct stat st;
+  if ( fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(Header) )
+    {
+      close(fd);
+      return;
+    }
+  _length = st.st_size;
+
+  void* base = mmap(0, _length, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if ( base == MAP_FAILED ) return;
+
+  // Check header
+
+  Header h;
+  memcpy(&h, base, sizeof(Header));
+  if ( memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+       h.version != VERSION || !valid(h, _length) )
+    {
+      munmap(base, _length);
+      return;
+    }
+
+  // Read column names
+
+  const char* p   = (const char*)base + sizeof(Header);
+  const char* end = (const char*)base + h.offset;
+  for (uint32_t i = 0; i < h.ncolumns; i++)
+    {
+      uint32_t len;
+      if ( p + sizeof(len) > end ) break;
+      memcpy(&len, p, sizeof(len));
+      p += sizeof(len);
+      if ( len > (size_t)(end - p) ) break;
+      _names.push_back(string(p, len));
+      p += len;
+    }
+  if ( _names.size() != h.ncolumns )
+    {
+      _names.clear();
+      munmap(base, _length);
+      return;
+    }
+
+  _nrows   = h.nrows;
+  _offset  = h.offset;
+  _colsize = h.colsize;
+  _base    = (char*)base;
+
+  // Columns are read front to back by loadFile(), but in shuffled
+  // blocks by PatternStream, so no access pattern is announced
+  madvise(_base, _length, MADV_NORMAL);
+}
+
+DataFile::~DataFile()
+{
+  if ( _base ) munmap(_base, _length);
+}
+
+int DataFile::index(string name) const
+{
+  for (int i = 0; i < (int)_names.size(); i++)
+    if ( _names[i] == name ) return i;
+  return -1;
+}
+
+const float* DataFile::column(int i) const
+{
+  if ( _base == 0 || i < 0 || i >= (int)_names.size() ) return 0;
+  return (const float*)(_base + _offset + i * _colsize);
+}
+
+int DataFile::write(string binaryfile,
+		    const vector<string>& names,
+		    const vector<const float*>& columns,
+		    size_t nrows)
+{
+  ofstream out(binaryfile.c_str(), ios::binary);
+  if ( !out ) return -1;
+
+  size_t namesize = 0;
+  for (size_t i = 0; i < names.size(); i++)
+    namesize += sizeof(uint32_t) + names[i].size();
+
+  Header h;
+  memcpy(h.magic, MAGIC, sizeof(MAGIC));
+  h.version  = VERSION;
+  h.ncolumns = names.size();
+  h.nrows    = nrows;
+  h.offset   = align(sizeof(Header) + namesize);
+  h.colsize  = align(nrows * sizeof(float));
+  out.write((const char*)&h, sizeof(Header));
+
+  for (size_t i = 0; i < names.size(); i++)
+    {
+      uint32_t len = names[i].size();
+      out.write((const char*)&len, sizeof(len));
+      out.write(names[i].data(), len);
+    }
+
+  vector<char> pad(ALIGN, 0);
+  out.write(&pad[0], h.offset - sizeof(Header) - namesize);
+
+  size_t padding = h.colsize - nrows * sizeof(float);
+  for (size_t i = 0; i < columns.size(); i++)
+    {
+      out.write((const char*)columns[i], nrows * sizeof(float));
+      out.write(&pad[0], padding);
+    }
+  out.close();
+  return out.fail() ? -1 : 0;
+}
+
+int DataFile::convert(string textfile, string binaryfile)
+{
+  ifstream inp(textfile.c_str());
+  if ( !inp ) return -1;
+
+  // Column names
+
+  string line;
+  getline(inp, line);
+  vector<string> names;
+  istringstream header(line);
+  string name;
+  while ( header >> name ) names.push_back(name);
+
+  // Rows
+
+  int ncolumns = names.size();
+  vector<vector<float> > columns(ncolumns);
+  while ( getline(inp, line) )
+    {
+      const char* p = line.c_str();
+      char* next;
+      int i = 0;
+      while ( true )
+	{
+	  float x = strtof(p, &next);
+	  if ( next == p ) break;
+	  if ( i < ncolumns ) columns[i].push_back(x);
+	  i++;
+	  p = next;
+	}
+      if ( i == 0 ) continue;        // blank line
+      if ( i != ncolumns ) return -2;
+    }
+
+  vector<const float*> data(ncolumns);
+  for (int i = 0; i < ncolumns; i++) data[i] = columns[i].data();
+
+  size_t nrows = ncolumns > 0 ? columns[0].size() : 0;
+  return write(binaryfile, names, data, nrows);
+}
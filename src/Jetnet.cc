@@ -19,6 +19,15 @@
 #include <stdio.h>
 
 #include "network.h"
+#include "jncommon.h"
+#include "JetnetContext.h"
+#include "ThreadPool.h"
+#include "DataFile.h"
+#include "WeightFile.h"
+#include "PatternStream.h"
+#include "BackProp.h"
+#include "AliasTable.h"
+#include "Permutation.h"
 #include "Jetnet.h"
 
 using namespace std;
@@ -84,46 +93,7 @@ using namespace jtn;
 
 // Definitions in global scope
 
-// External functions
-
-extern "C" 
-{
-  void jninit_(void);
-  void jntral_(void);
-  void jntest_(void);
-
-  void jnreadweights_   (const char* filename, int* status, int);
-  void jndumpparams_    (void);
-  void jndumpweights_   (const char* filename, int);
-  void jndumpweightsmlp_(const char* filename, int);
-  void jnwritename_     (const char* filename, float& mean, float& sigma, int);
-  void jncloseweights_  (int& outtype);
-}
-
-//  Declare JETNET common blocks
-
-const int MAXI = 50000;
-const int MAXO = 1000;
-
-extern struct jndat1 
-{
-  int   mstjn[40];
-  float parjn[40];
-  int   mstjm[20];
-  float parjm[20];
-  float oin[MAXI];
-  float out[MAXO];
-  int   mxndjm;
-} jndat1_; // Note: all FORTRAN names are postfixed with an "_"
-
-extern struct jndat2
-{
-  float  tinv[10];
-  int    igfn[10];
-  float  etal[10];
-  float  widl[10];
-  float  satm[10];
-} jndat2_; // Note: all FORTRAN names are postfixed with an "_"
+// JETNET routines and common blocks are declared in jncommon.h
 
 double sigmoid(double x)
 {
@@ -135,6 +105,39 @@ double sigmoidout(double x)
   return 1.0/(1.0+exp(-2*x));
 }
 
+// Defaults of the members that the constructors do not set from
+// their arguments
+
+void Jetnet::_defaults()
+{
+  _table          = 0;
+  _nsnapshots     = 5;
+  _patience       = 10;
+  _criterion      = kRMS;
+  _validationSize = 0;
+  _nsigma         = 2;
+  _bestEpoch      = 0;
+  _bestScore      = 0;
+  _wscale         = 1;
+  _resample       = false;
+  _reshuffle      = true;
+  _shuffleBlock   = 0;
+  _shuffleSeed    = 0;
+  _native         = true;
+  _prenormalize   = false;
+  _epochError     = 0;
+  _epochRMS       = -1;
+  _logPending     = false;
+  _nthreads       = 0;
+  _pool           = 0;
+  _stream         = 0;
+  _backprop       = 0;
+  _alias          = 0;
+  _order          = 0;
+  _log            = 0;
+  _ctx            = 0;
+}
+
 // Constructor
 
 Jetnet::Jetnet(string var, int hidden, Output outType)
@@ -142,7 +145,8 @@ Jetnet::Jetnet(string var, int hidden, Output outType)
     _sample(kTRAINING),
     _outputType(0),
     _initialized(false)
-{ 
+{
+  _defaults();
   _init(var, hidden, outType); 
 }
 
@@ -152,6 +156,7 @@ Jetnet::Jetnet(vector<string>& variables, int hidden, Output outType)
     _outputType(0),
     _initialized(false)
 {
+  _defaults();
   string var("");
   for(int i=0; i < (int)variables.size(); i++) var += variables[i] + '\t';
   _init(var, hidden, outType);
@@ -166,6 +171,7 @@ Jetnet::Jetnet(string filename)
     _outputType(0),
     _initialized(false)
 {
+  _defaults();
   _nodes.clear();
   _wgt.clear();
   _mean.clear();
@@ -177,13 +183,23 @@ Jetnet::Jetnet(string filename)
       exit(0);
     }
   _init();
+  _compile();
   _initialized = true;
 }
 
   
 // Destructor
 
-Jetnet::~Jetnet(){}
+Jetnet::~Jetnet()
+{
+  setLog("");
+  delete _backprop;
+  delete _alias;
+  delete _order;
+  delete _stream;
+  delete _pool;
+  delete _ctx;
+}
 
 
 // Setters
@@ -232,13 +248,22 @@ void Jetnet::setDeta(float val)
   setParameter("deta",val);
 }
 
+void Jetnet::setThreads(int nthreads)
+{
+  if ( nthreads == _nthreads ) return;
+  _nthreads = nthreads;
+  delete _pool;
+  _pool = 0;
+}
+
 void Jetnet::setSample(Sample sample)
 {
   _sample = sample;
 }
 
 void Jetnet::setPattern(vfloat& inp, 
-                    float   out)
+                    float   out,
+                    float   weight)
 {
   // Check size of inputs and outputs
   if ( (int)inp.size() < _ninput )
@@ -250,26 +275,166 @@ void Jetnet::setPattern(vfloat& inp,
       exit(0);
     }
 
-  _input[_sample].push_back(inp); // Makes a copy of object
-  _output[_sample].push_back(out);
+  _patterns(_sample).add(&inp[0], out, weight); // Makes a copy of object
 }
 
 void Jetnet::setPattern(vdouble& inp, 
-                    double   out)
+                    double   out,
+                    double   weight)
 {
-  vector<float> input(inp.size());
-  for(int i=0; i < (int)inp.size(); i++) input[i] = (float)inp[i];
-  float output = (float)out;
-  setPattern(input, output);
+  // Check size of inputs and outputs
+  if ( (int)inp.size() < _ninput )
+    {
+      _status = kBADINPSIZE;
+      cout << "Jetnet::setPattern - mis-match in length of input data" << endl;
+      cout << "               - inp.size(): " << inp.size() << endl;
+      cout << "               - ninput:     " << _ninput << endl;
+      exit(0);
+    }
+
+  _patterns(_sample).add(&inp[0], (float)out, (float)weight); // Makes a copy
+}
+
+void Jetnet::reserve(size_t npatterns)
+{
+  _patterns(_sample).reserve(npatterns);
 }
 
 void Jetnet::loadPatterns(vvfloat& inp, 
 		      vfloat&  out)
 {
+  PatternStore& store = _patterns(_sample);
+  store.reserve(store.size() + inp.size());
   for (int i = 0; i < (int)inp.size(); i++)
     setPattern(inp[i], out[i]);
 }
 
+void Jetnet::loadPatterns(const float* data, 
+			  size_t nrows, 
+			  size_t ncols, 
+			  size_t rowStride,
+			  const float* targets, 
+			  Sample sample,
+			  const vint& columns,
+			  const float* weights)
+{
+  vint cols;
+  if ( ! _columns(ncols, columns, cols) ) return;
+  _patterns(sample).add(data, nrows, rowStride, &cols[0], targets, weights);
+}
+
+void Jetnet::loadPatterns(const double* data, 
+			  size_t nrows, 
+			  size_t ncols, 
+			  size_t rowStride,
+			  const double* targets, 
+			  Sample sample,
+			  const vint& columns,
+			  const double* weights)
+{
+  vint cols;
+  if ( ! _columns(ncols, columns, cols) ) return;
+  _patterns(sample).add(data, nrows, rowStride, &cols[0], targets, weights);
+}
+
+bool Jetnet::loadFile(string filename, 
+		      float  target, 
+		      Sample sample,
+		      size_t first,
+		      size_t count,
+		      string weight)
+{
+  DataFile file(filename);
+  if ( ! file.good() )
+    {
+      _status = kFILEOPENERROR;
+      cout << "Jetnet::loadFile - unable to read " << filename << endl;
+      return false;
+    }
+
+  if ( first > file.rows() ) first = file.rows();
+  if ( count == 0 || first + count > file.rows() ) count = file.rows() - first;
+
+  // Select network inputs by name
+
+  vector<const float*> columns;
+  for (int j = 0; j < _ninput; j++)
+    {
+      int i = file.index(_var[j]);
+      if ( i < 0 )
+	{
+	  _status = kBADNAME;
+	  cout << "Jetnet::loadFile - variable " << _var[j] 
+	       << " not found in " << filename << endl;
+	  return false;
+	}
+      columns.push_back(file.column(i) + first);
+    }
+
+  const float* weights = 0;
+  if ( weight != "" )
+    {
+      int i = file.index(weight);
+      if ( i < 0 )
+	{
+	  _status = kBADNAME;
+	  cout << "Jetnet::loadFile - weight " << weight
+	       << " not found in " << filename << endl;
+	  return false;
+	}
+      weights = file.column(i) + first;
+    }
+
+  _patterns(sample).add(&columns[0], count, target, weights);
+  _status = kSUCCESS;
+  return true;
+}
+
+const PatternStore& Jetnet::patterns(Sample sample)
+{
+  return _samples(sample);
+}
+
+void Jetnet::sharePatterns(Sample sample, const PatternStore& store)
+{
+  _status = kSUCCESS;
+  if ( store.columns() != _ninput )
+    {
+      _status = kBADINPSIZE;
+      cout << "Jetnet::sharePatterns - mis-match in number of inputs" << endl;
+      return;
+    }
+  _shared[sample] = &store;
+  _normalized.erase(sample);
+  _input[sample]  = PatternStore(_ninput);
+}
+
+bool Jetnet::addStream(string filename, float target, string weight)
+{
+  int code = _patternstream()->add(filename, target, _var, weight);
+  if ( code == -1 )
+    {
+      _status = kFILEOPENERROR;
+      cout << "Jetnet::addStream - unable to read " << filename << endl;
+      return false;
+    }
+  else if ( code < 0 )
+    {
+      _status = kBADNAME;
+      cout << "Jetnet::addStream - input variables not found in " 
+	   << filename << endl;
+      return false;
+    }
+  _status = kSUCCESS;
+  return true;
+}
+
+void Jetnet::setStreamBuffer(size_t blockSize, size_t bufferSize)
+{
+  _patternstream()->setBlockSize(blockSize);
+  _patternstream()->setBufferSize(bufferSize);
+}
+
 // Getters
 //////////
 
@@ -279,13 +444,14 @@ float Jetnet::parameter(string name)
   if ( _id.find(name) == _id.end() ) 
     return val;
 
+  JetnetContext* jn = _context();
   ID a = _id[name];
   if      ( a.type == 0 )
-    val = (float)jndat1_.mstjn[a.index];
+    val = (float)jn->mstjn[a.index];
   else if ( a.type == 1 )
-    val = jndat1_.parjn[a.index];
+    val = jn->parjn[a.index];
   else if ( a.type == 4 )
-    val = (float)jndat2_.igfn[_nlayer-2];
+    val = (float)jn->dat2.igfn[_nlayer-2];
   return val;
 }
 
@@ -299,62 +465,106 @@ vstring Jetnet::names()
 ///////////////////////////////////////////////////////////
 float Jetnet::evaluate(vfloat& inp)
 {
-  // load pattern into array oin(*) 
-
-  for (int j=0; j < _ninput; j++)
-    {
-      jndat1_.oin[j] = (inp[j] - _mean[j]) / _sigma[j];
-    }
-  // Run network
-
-  jntest_(); 
+  return _table ? _tabulated.evaluate(inp) : _network.evaluate(inp);
+}
 
-  // Get network output
+float Jetnet::evaluate(vdouble& inp)
+{
+  return _table ? _tabulated.evaluate(inp) : _network.evaluate(inp);
+}
 
-  return jndat1_.out[0];
+void Jetnet::evaluateBatch(const float* rows, size_t n, size_t stride, 
+			   float* out)
+{
+  if ( _table )
+    _tabulated.evaluate(rows, n, stride, out);
+  else
+    _network.evaluate(rows, n, stride, out);
 }
 
-float Jetnet::evaluate(vdouble& inp)
+void Jetnet::setActivationTable(double maxError)
 {
-  // load pattern into array oin(*) 
+  _table = maxError > 0 ? ActivationTable::forError(maxError) : 0;
+  _tabulated = _table ? _network.tabulated(_table) : CompiledNetwork();
+}
 
-  for (int j=0; j < _ninput; j++)
+QuantizedNetwork Jetnet::quantize(int bits, Sample calibration)
+{
+  _status = kSUCCESS;
+  if ( bits != 8 && bits != 16 )
     {
-      jndat1_.oin[j] = (inp[j] - _mean[j]) / _sigma[j];
+      cout << "Jetnet::quantize - bits must be 8 or 16" << endl;
+      _status = kFAILURE;
+      return QuantizedNetwork();
+    }
+  if ( _input.find(calibration) == _input.end() &&
+       _shared.find(calibration) == _shared.end() )
+    {
+      _status = kBADSAMPLE;
+      return QuantizedNetwork();
     }
-  // Run network
-
-  jntest_(); 
 
-  // Get network output
+  const PatternStore& cal = _samples(calibration);
+  QuantizedNetwork q(_network, cal.data(), cal.size(), cal.stride(), bits);
 
-  return jndat1_.out[0];
+  if ( _input.find(kTESTING)  != _input.end() ||
+       _shared.find(kTESTING) != _shared.end() )
+    {
+      const PatternStore& test = _samples(kTESTING);
+      if ( test.size() > 0 )
+	{
+	  q.compare(_network, test.data(), test.size(), test.stride(),
+		    test.targets(), test.weights());
+	  q.printReport();
+	}
+    }
+  return q;
 }
 
-void Jetnet::save(string file, bool savecpp)
+void Jetnet::save(string file, bool savecpp, Code code)
 {
   // JETNET format
 
   file = jtn::truncate(file,".");
-  string file1 = file + ".jetnet";
-  jndumpweights_(file1.c_str(), file1.length());
 
-  // MLPfit format
+  // Binary format
+
+  _getweights();
+  string file3 = file + ".jnw";
+  WeightFile::write(file3, _nodes, _wgt, _var, _mean, _sigma, _outputType);
 
+  string file1 = file + ".jetnet";
   string file2 = file + ".net";
-  jndumpweightsmlp_(file2.c_str(), file2.length());
+  if ( _state.fits() )
+    {
+      JetnetContext* jn = _context();
+      jn->enter();
+      _state.store();
+      jndumpweights_(file1.c_str(), file1.length());
+
+      // MLPfit format
 
-  for (int i = 0; i < (int)_var.size(); i++)
-    jnwritename_(_var[i].c_str(), _mean[i], _sigma[i], _var[i].size());
+      jndumpweightsmlp_(file2.c_str(), file2.length());
+
+      for (int i = 0; i < (int)_var.size(); i++)
+	jnwritename_(_var[i].c_str(), _mean[i], _sigma[i], _var[i].size());
   
-  jncloseweights_(_outputType);
+      jncloseweights_(_outputType);
+      jn->leave();
+    }
+  else
+    {
+      // Too large for JETNET; write MLPfit format only
+      WeightFile::dump(file3, file2);
+    }
   
-  if ( savecpp ) _saveCPP(file);
+  if ( savecpp ) _saveCPP(file, code);
 }
 
 
 void Jetnet::printParameters(int flag)
 {
+  JetnetContext* jn = _context();
   cout << "Network Parameters\n";
   if     ( flag == 0 )
     {
@@ -366,13 +576,13 @@ void Jetnet::printParameters(int flag)
 	  cout << key.substr(0,20); 
 	  if      (id.type == 0)
 	    cout << " MSTJN[" << setw(2) << id.index+1 << "] = " 
-		 << setw(10)  << jndat1_.mstjn[id.index]; 
+		 << setw(10)  << jn->mstjn[id.index]; 
 	  else if (id.type == 1)
 	    cout << " PARJN[" << setw(2) << id.index+1 << "] = " 
-		 << setw(10)  << jndat1_.parjn[id.index];
+		 << setw(10)  << jn->parjn[id.index];
 	  else if (id.type == 4)
 	    cout << "  IGFN[" << setw(2) << _nlayer-1 << "] = " 
-		 << setw(10)  << jndat2_.igfn[_nlayer-2];
+		 << setw(10)  << jn->dat2.igfn[_nlayer-2];
 	  cout << endl;
 	}
     }
@@ -383,13 +593,15 @@ void Jetnet::printParameters(int flag)
 	  printf
 	    ("mstjn[%2d] = %d\t mstjn[%2d] "
 	     "= %d\t parjn[%2d] = %f\t parjn[%2d] = %f\n",
-	     i+1,jndat1_.mstjn[i], i+2,jndat1_.mstjn[i+1],
-	     i+1,jndat1_.parjn[i], i+2,jndat1_.parjn[i+1]);
+	     i+1,jn->mstjn[i], i+2,jn->mstjn[i+1],
+	     i+1,jn->parjn[i], i+2,jn->parjn[i+1]);
 	}
     }
   else
     {
+      jn->enter();
       jndumpparams_();
+      jn->leave();
     }
 }
 
@@ -405,8 +617,18 @@ bool Jetnet::begin(string filename)
       _setParameter("method");
       _setParameter("width");
       
-      // Initialize JETNET
-      jninit_();
+      // Initialize JETNET or, if the network is too large for the
+      // JETNET common blocks, the native network state
+      JetnetContext* jn = _context();
+      if ( NetworkState::fits(_nodes) )
+	{
+	  jn->enter();
+	  jninit_();
+	  _state.load();
+	  jn->leave();
+	}
+      else
+	_state.initialize(*jn);
       
       _setParameter("alpha");
       _setParameter("eta");
@@ -422,16 +644,20 @@ bool Jetnet::begin(string filename)
   // Define number of updates per cycle
 
   int  patterns_per_update = (int)parameter("patternsPerUpdate");
-  int  updates_per_cycle   = _input[_sample].size()/patterns_per_update;
+  int  npatterns = _stream ? _stream->size() : _samples(_sample).size();
+  int  updates_per_cycle   = npatterns/patterns_per_update;
   if ( updates_per_cycle < 1 ) updates_per_cycle = 1;
   
   setParameter("updatesPerCycle", (float)updates_per_cycle);
 
-  // Randomly shuffle patterns
-  _setpattern(kTRAINING);
-  _setpattern(kTESTING);
   // scale data
   _findscale();
+  _normalize();
+  _resampling();
+  _shuffling();
+  resetStats();
+
+  _compile();
 
    // Improve error handling later!
   return true;
@@ -440,129 +666,495 @@ bool Jetnet::begin(string filename)
 void Jetnet::save()
 {
   save(".jetnet",false);  // do not save cpp file 
-  _load(".jetnet",0);     // load weight file in MLP format
 }
 
-float Jetnet::train()
+void Jetnet::snapshot(float rms)
 {
-  // Training loop 
- 
-  for (int p=0; p < (int)_input[_sample].size(); p++ )
-    {
-      // load pattern into array oin(*) 
+  _getweights();
 
-      for (int j=0; j < _ninput; j++)
-	jndat1_.oin[j] = (_input[_sample][p][j] - _mean[j]) / _sigma[j];
+  // Keep snapshots in increasing order of rms
 
-      // load target into array out(*) 
+  vector<pair<float, vdouble> >::iterator it = _snapshots.begin();
+  while ( it != _snapshots.end() && it->first <= rms ) it++;
+  if ( it - _snapshots.begin() >= _nsnapshots ) return;
 
-      jndat1_.out[0] = _output[_sample][p];
-	   
-      // apply training algorithm 
+  _snapshots.insert(it, make_pair(rms, _wgt));
+  if ( (int)_snapshots.size() > _nsnapshots ) _snapshots.pop_back();
+}
 
-      jntral_();
+void Jetnet::setSnapshots(int n)
+{
+  _nsnapshots = max(n, 0);
+  if ( (int)_snapshots.size() > _nsnapshots ) _snapshots.resize(_nsnapshots);
+}
 
-    } // End of training loop
- 
-  return parameter("error");
+float Jetnet::snapshotRMS(int i)
+{
+  if ( i < 0 || i >= (int)_snapshots.size() ) return -99.0;
+  return _snapshots[i].first;
 }
 
+bool Jetnet::restore(int i)
+{
+  if ( i < 0 || i >= (int)_snapshots.size() ) return false;
+  _wgt = _snapshots[i].second;
+  _setweights();
+  _compile();
+  return true;
+}
 
-float Jetnet::test(Sample sample, float cutpoint, int nbin)
+void Jetnet::setEarlyStopping(int patience, 
+			      Criterion criterion,
+			      size_t subsample, 
+			      float nsigma)
 {
-  _status = kSUCCESS;
-  if ( _input.find(sample) == _input.end() )
+  _patience       = max(patience, 0);
+  _criterion      = criterion;
+  _validationSize = subsample;
+  _nsigma         = nsigma;
+}
+
+void Jetnet::setShuffling(bool everyEpoch, size_t blockSize, 
+			  unsigned long long seed)
+{
+  _reshuffle    = everyEpoch;
+  _shuffleBlock = blockSize;
+  _shuffleSeed  = seed;
+  if ( _order != 0 ) _shuffling();
+}
+
+void Jetnet::setNativeTraining(bool native)
+{
+  _native = native;
+}
+
+void Jetnet::setNormalizedCopy(bool keep)
+{
+  _prenormalize = keep;
+  if ( !keep ) _normalized.clear();
+}
+
+int Jetnet::fit(int maxEpochs)
+{
+  size_t ntest = _samples(kTESTING).size();
+  if ( ntest == 0 )
     {
       _status = kBADSAMPLE;
-      return -99.0;
+      cout << "Jetnet::fit - no testing patterns" << endl;
+      return 0;
     }
 
-  // Clear histograms
+  // Random subsample of the testing patterns, in their original order
 
-  _es.clear();
-  _eb.clear();
-  _s.clear();
-  _b.clear();
-  for (int k = 0; k < nbin; k++ )
+  PatternStore subsample(_ninput);
+  if ( _validationSize > 0 && _validationSize < ntest )
     {
-      _es.push_back(0);
-      _eb.push_back(0);
-      _s.push_back(0);
-      _b.push_back(0);
+      const PatternStore& test = _samples(kTESTING);
+      Permutation pick(_seed());
+      vint rows(pick.shuffle(ntest));
+      rows.resize(_validationSize);
+      sort(rows.begin(), rows.end());
+      for (size_t i = 0; i < rows.size(); i++)
+	subsample.add(test.row(rows[i]), test.target(rows[i]), 
+		      test.weight(rows[i]));
     }
 
-  // Testing loop
+  vdouble best;
+  float   bestloss = 0;
+  int     wait  = 0;
+  int     epoch = 0;
+  _bestEpoch = 0;
+  while ( epoch < maxEpochs )
+    {
+      train();
+      epoch++;
+      if ( !good() ) break;
 
-  int total = 0;
-  _rms = 0.0;      // rms error 
-  _error = 0.0;    // mis-classification rate
-  _divergencebyMC = 0;
+      // Validate on the subsample; claim a new best network unless 
+      // it is significantly worse than the best one
 
-  for (int p=0; p < (int)_input[sample].size(); p++ ) // Begin testing loop
-    {
-      // load pattern into array oin(*) 
+      bool claim = true;
+      if ( _bestEpoch > 0 && subsample.size() > 0 )
+	{
+	  float error;
+	  _test(kTESTING, 0.5, 50, &subsample);
+	  float loss = _loss(error);
+	  claim = loss - _nsigma * error < bestloss;
+	}
 
-      for (int j=0; j < _ninput; j++)
-	jndat1_.oin[j] = (_input[sample][p][j] - _mean[j]) / _sigma[j];
+      if ( claim )
+	{
+	  float error;
+	  test(kTESTING);
+	  float loss = _loss(error);
+	  if ( _bestEpoch == 0 || loss < bestloss )
+	    {
+	      _getweights();
+	      best       = _wgt;
+	      bestloss   = loss;
+	      _bestEpoch = epoch;
+	      wait       = 0;
+	      continue;
+	    }
+	}
+      if ( _patience > 0 && ++wait >= _patience ) break;
+    }
+
+  if ( _bestEpoch > 0 )
+    {
+      _bestScore = _criterion == kAREA ? -bestloss : bestloss;
+      _wgt = best;
+      _setweights();
+      _compile();
+    }
+  return epoch;
+}
 
-      // Run network
+float Jetnet::train()
+{
+  _logEpoch();
+  _epochStats.reset();
+  JetnetContext* jn = _context();
+  int    nwarn = jn->mstjn[33];
+  double t0    = TrainingStats::clock();
 
-      jntest_(); 
+  if ( _stream && _sample == kTRAINING )
+    {
+      // Training loop over shuffled chunks read from disk
 
-      // Network output
+      PatternStore chunk(_ninput);
+      _stream->start();
+      while ( _stream->next(chunk) ) _train(chunk);
+      _stream->stop();
+    }
+  else if ( _resample && _sample == kTRAINING && _alias != 0 )
+    {
+      // Draw this epoch's patterns according to their weights
 
-      float out = jndat1_.out[0];
-      float target = _output[sample][p];
-      int   bin = (int)(out * nbin);
+      const PatternStore& input = _samples(kTRAINING);
+      if ( _alias->size() != input.size() ) _resampling();
+      if ( _order == 0 ) _shuffling();
 
-      // Apply cut
+      // The column is an integer from the 64-bit generator of the
+      // permutation: RJN has only 24 bits, too few for large samples
 
-      if ( target > 0.5 )
+      uint32_t ncol = (uint32_t)_alias->size();
+      _draws.resize(input.size());
+      for (size_t i = 0; i < _draws.size(); i++)
 	{
-	  if ( out < cutpoint ) _error += 1;
+	  uint32_t column = _order->below(ncol);
+	  _draws[i] = _alias->draw(column, jn->rjn());
 	}
+      const PatternStore* normalized = _normalizedSample(kTRAINING);
+      if ( normalized )
+	_train(*normalized, &_draws, true, true);
       else
+	_train(input, &_draws, true);
+    }
+  else
+    {
+      // Visit the patterns in random order, drawn for each epoch
+
+      const PatternStore& input = _samples(_sample);
+      if ( _order == 0 ) _shuffling();
+      if ( _reshuffle || _order->size() != input.size() )
+	_order->shuffle(input.size(), _shuffleBlock);
+      const PatternStore* normalized = _normalizedSample(_sample);
+      if ( normalized )
+	_train(*normalized, &_order->order(), false, true);
+      else
+	_train(input, &_order->order());
+    }
+
+  _compile();
+
+  TrainingStats& e = _epochStats;
+  e._epochs   = 1;
+  e._seconds  = TrainingStats::clock() - t0;
+  e._restarts = jn->mstjn[37];
+  e._warnings = jn->mstjn[33] - nwarn;
+  e._lastWarning = e._warnings > 0 ? jn->mstjn[32] : 0;
+  _stats.add(e);
+
+  _epochError = parameter("error");
+  _epochRMS   = -1;
+  _logPending = _log != 0;
+  return _epochError;
+}
+
+void Jetnet::resetStats()
+{
+  _stats.reset();
+  _epochStats.reset();
+}
+
+bool Jetnet::setLog(string filename)
+{
+  _logEpoch();
+  delete _log;
+  _log = 0;
+  if ( filename == "" ) return true;
+
+  ofstream* out = new ofstream(filename.c_str());
+  if ( !*out )
+    {
+      cout << "Jetnet::setLog - unable to open " << filename << endl;
+      delete out;
+      return false;
+    }
+  _log = out;
+  return true;
+}
+
+// Write the log line of the last epoch, once its tests are done
+
+void Jetnet::_logEpoch()
+{
+  if ( _log != 0 && _logPending )
+    {
+      string line = _epochStats.json(_stats.epochs(), _epochError);
+      if ( _epochRMS >= 0 )
 	{
-	  if ( out > cutpoint ) _error += 1;
+	  ostringstream os;
+	  os << ", \"test_rms\": " << _epochRMS << "}";
+	  line = line.substr(0, line.size() - 1) + os.str();
 	}
+      *_log << line << endl;
+    }
+  _logPending = false;
+}
 
-      double x = out - target;
-      _rms += x*x;
+// Number of patterns in each chunk of the testing loop. The chunk size 
+// (not the number of threads) determines the order of summation.
+const int TESTCHUNK = 4096;
+
+namespace {
+  struct TestSums
+  {
+    double sumw;
+    double sumw2;
+    double rms;
+    double rms2;
+    double error;
+    double divergence;
+    double total;
+  };
+};
 
-      // Fill histograms
+float Jetnet::test(Sample sample, float cutpoint, int nbin)
+{
+  return _test(sample, cutpoint, nbin);
+}
 
-      if ( target > 0.5 )
-	{	  
-	  _s[bin]++;
-	  if ( out != 1.0 )
-	    {
-	      _divergencebyMC += log(out/(1-out));
-	      total++;
-	    }
-	}
+// Test on the sample or, if given, on a subsample of it
+
+float Jetnet::_test(Sample sample, float cutpoint, int nbin, 
+		    const PatternStore* subsample)
+{
+  double t0 = TrainingStats::clock();
+  _status = kSUCCESS;
+  if ( _input.find(sample) == _input.end() &&
+       _shared.find(sample) == _shared.end() )
+    {
+      _status = kBADSAMPLE;
+      return -99.0;
+    }
+
+  const PatternStore* normalized = subsample ? 0 : _normalizedSample(sample);
+  const PatternStore& input = subsample ? *subsample 
+    : (normalized ? *normalized : _samples(sample));
+  int npat    = input.size();
+  int nchunk  = (npat + TESTCHUNK - 1) / TESTCHUNK;
+
+  jtn::ThreadPool* pool = _threadpool();
+
+  // Histograms and sums per chunk. The histograms are sums of
+  // weights, so they are merged in chunk order.
+
+  vvdouble s(nchunk, vdouble(nbin, 0));
+  vvdouble b(nchunk, vdouble(nbin, 0));
+  vector<TestSums> sums(nchunk);
+
+  // Testing loop
+
+  pool->run(nchunk, [&](int chunk, int thread)
+    {
+      int first = chunk * TESTCHUNK;
+      int count = min(TESTCHUNK, npat - first);
+
+      // Score chunk as a batch
+
+      float out[TESTCHUNK];
+      if ( normalized )
+	_network.evaluateNormalized(input.row(first), count, input.stride(), 
+				    out);
       else
+	_network.evaluate(input.row(first), count, input.stride(), out);
+
+      TestSums& sum = sums[chunk];
+      sum.sumw = sum.sumw2 = 0;
+      sum.rms = sum.rms2 = sum.error = sum.divergence = 0;
+      sum.total = 0;
+
+      for (int p = 0; p < count; p++)
 	{
-	  _b[bin]++;
+	  float target = input.target(first+p);
+	  double w = input.weight(first+p);
+	  sum.sumw  += w;
+	  sum.sumw2 += w*w;
+	  int   bin = (int)(out[p] * nbin);
+	  if ( bin < 0 )     bin = 0;
+	  if ( bin >= nbin ) bin = nbin-1;
+
+	  // Apply cut
+
+	  if ( target > 0.5 )
+	    {
+	      if ( out[p] < cutpoint ) sum.error += w;
+	    }
+	  else
+	    {
+	      if ( out[p] > cutpoint ) sum.error += w;
+	    }
+
+	  double x = out[p] - target;
+	  sum.rms  += w*x*x;
+	  sum.rms2 += w*x*x*x*x;
+
+	  // Fill histograms
+
+	  if ( target > 0.5 )
+	    {	  
+	      s[chunk][bin] += w;
+	      if ( out[p] != 1.0 )
+		{
+		  sum.divergence += w*log(out[p]/(1-out[p]));
+		  sum.total += w;
+		}
+	    }
+	  else
+	    {
+	      b[chunk][bin] += w;
+	    }
 	}
+    });
+
+  // Merge histograms and sums
+
+  _s = vdouble(nbin, 0);
+  _b = vdouble(nbin, 0);
+  for (int c = 0; c < nchunk; c++)
+    for (int k = 0; k < nbin; k++ )
+      {
+	_s[k] += s[c][k];
+	_b[k] += b[c][k];
+      }
+
+  double sumw = 0, sumw2 = 0;
+  double rms = 0, rms2 = 0, error = 0, divergence = 0, total = 0;
+  for (int c = 0; c < nchunk; c++)
+    {
+      sumw       += sums[c].sumw;
+      sumw2      += sums[c].sumw2;
+      rms        += sums[c].rms;
+      rms2       += sums[c].rms2;
+      error      += sums[c].error;
+      divergence += sums[c].divergence;
+      total      += sums[c].total;
     }
 
   // Compute some useful statistics
 
+  _es = vfloat(nbin, 0);
+  _eb = vfloat(nbin, 0);
   nnefficiencies(_s, _es);
   nnefficiencies(_b, _eb);
   _area  = nnarea(_eb, _es);
   _power = nnpower(_s, _b);
   _divergence = nndivergence(_s, _b);
 
-  if ( total > 0 ) _divergencebyMC /= total;
+  _divergencebyMC = total > 0 ? divergence / total : 0;
+
+  _error = error/sumw;
+  _rms   = sqrt(rms/sumw);
+
+  // Standard error of the rms, from that of the mean squared error,
+  // using the effective number of patterns
 
-  _error = _error/_input[sample].size();
-  _rms   = sqrt(_rms/_input[sample].size());
+  _neff = sumw2 > 0 ? sumw * sumw / sumw2 : 0;
+  double var = rms2/sumw - (rms/sumw) * (rms/sumw);
+  _rmserror = _rms > 0 ? sqrt(max(var, 0.0) / _neff) / (2 * _rms) : 0;
+
+  double t = TrainingStats::clock() - t0;
+  _epochStats._time[TrainingStats::kTEST] += t;
+  _stats._time[TrainingStats::kTEST] += t;
+  if ( sample == kTESTING && subsample == 0 ) _epochRMS = _rms;
 
   return _rms;
 }
 
-vint Jetnet::histogram(int target)
+// Figure of merit of the last test, as a loss (smaller is better), 
+// and its standard error. The error of the area is that of Hanley
+// and McNeil (Radiology 143 (1982) 29).
+
+float Jetnet::_loss(float& error)
+{
+  if ( _criterion == kRMS )
+    {
+      error = _rmserror;
+      return _rms;
+    }
+
+  // Effective numbers of signal and background patterns
+
+  double ns = 0, nb = 0;
+  for (int k = 0; k < (int)_s.size(); k++)
+    {
+      ns += _s[k];
+      nb += _b[k];
+    }
+  if ( ns + nb > 0 )
+    {
+      double scale = _neff / (ns + nb);
+      ns *= scale;
+      nb *= scale;
+    }
+  double a  = _area;
+  double q1 = a / (2 - a);
+  double q2 = 2 * a * a / (1 + a);
+  double var = a * (1 - a) + (ns - 1) * (q1 - a * a) + (nb - 1) * (q2 - a * a);
+  error = ns > 0 && nb > 0 ? sqrt(max(var, 0.0) / (ns * nb)) : 0;
+  return -_area;
+}
+
+ROC Jetnet::roc(Sample sample)
+{
+  _status = kSUCCESS;
+  if ( _input.find(sample) == _input.end() &&
+       _shared.find(sample) == _shared.end() )
+    {
+      _status = kBADSAMPLE;
+      return ROC();
+    }
+
+  const PatternStore& input = _samples(sample);
+  int npat   = input.size();
+  int nchunk = (npat + TESTCHUNK - 1) / TESTCHUNK;
+
+  vfloat out(npat);
+  vfloat target(npat);
+  jtn::ThreadPool* pool = _threadpool();
+  pool->run(nchunk, [&](int chunk, int thread)
+    {
+      int first = chunk * TESTCHUNK;
+      int count = min(TESTCHUNK, npat - first);
+      _network.evaluate(input.row(first), count, input.stride(), &out[first]);
+      for (int p = first; p < first + count; p++) target[p] = input.target(p);
+    });
+  return ROC(out.data(), target.data(), npat, pool, input.weights());
+}
+
+vdouble Jetnet::histogram(int target)
 {
   if ( target > 0.5 )
     return _s;
@@ -610,15 +1202,94 @@ bool Jetnet::good()
 // Internal methods
 ///////////////////
 
+// Return pattern store of given sample, creating it if needed. The 
+// sample is no longer shared.
+
+PatternStore& Jetnet::_patterns(Sample sample)
+{
+  _shared.erase(sample);
+  _normalized.erase(sample);
+  PatternStore& store = _input[sample];
+  if ( store.columns() != _ninput && store.size() == 0 )
+    store = PatternStore(_ninput);
+  return store;
+}
+
+// Return patterns of given sample, which may belong to another network
+
+const PatternStore& Jetnet::_samples(Sample sample)
+{
+  map<Sample, const PatternStore*>::iterator it = _shared.find(sample);
+  if ( it != _shared.end() ) return *it->second;
+  return _input[sample];
+}
+
+// Check column selection of a bulk load; by default use the first 
+// _ninput columns
+
+bool Jetnet::_columns(size_t ncols, const vint& columns, vint& cols)
+{
+  _status = kSUCCESS;
+  if ( columns.size() == 0 )
+    for (int j = 0; j < _ninput; j++) cols.push_back(j);
+  else
+    cols = columns;
+
+  bool okay = (int)cols.size() == _ninput;
+  for (int j = 0; j < (int)cols.size(); j++)
+    okay = okay && cols[j] >= 0 && cols[j] < (int)ncols;
+
+  if ( ! okay )
+    {
+      _status = kBADINPSIZE;
+      cout << "Jetnet::loadPatterns - bad column selection" << endl;
+      cout << "               - ncols:      " << ncols << endl;
+      cout << "               - columns:    " << cols.size() << endl;
+      cout << "               - ninput:     " << _ninput << endl;
+    }
+  return okay;
+}
+
+jtn::ThreadPool* Jetnet::_threadpool()
+{
+  if ( _pool == 0 )
+    {
+      int nthreads = _nthreads;
+      if ( nthreads <= 0 ) nthreads = thread::hardware_concurrency();
+      _pool = new jtn::ThreadPool(nthreads);
+    }
+  return _pool;
+}
+
+JetnetContext* Jetnet::_context()
+{
+  if ( _ctx == 0 ) _ctx = new JetnetContext();
+  return _ctx;
+}
+
+PatternStream* Jetnet::_patternstream()
+{
+  if ( _stream == 0 ) _stream = new PatternStream(_ninput);
+  return _stream;
+}
+
 // Read contents of weight file
 
 bool Jetnet::_load(string filename, int which)
 {
+  _normalized.clear();
+  int n = filename.size();
+  if ( n > 4 && filename.substr(n-4) == ".jnw" ) return _loadBinary(filename);
+
   if ( which == 1 )
     {
       filename = jtn::truncate(filename,".")+".jetnet";
       int istatus;
+      JetnetContext* jn = _context();
+      jn->enter();
       jnreadweights_(filename.c_str(), &istatus, filename.length());
+      _state.load();
+      jn->leave();
     }
   
   // Read weight file in MLP format; extension must be "net"
@@ -638,73 +1309,393 @@ bool Jetnet::_load(string filename, int which)
     }
 }
 
+// Read binary weight file and set up JETNET with the same network
+
+bool Jetnet::_loadBinary(string filename)
+{
+  WeightFile wf(filename);
+  if ( !wf.good() || wf.nodes().size() > 11 )
+    {
+      _status = kFILEOPENERROR;
+      return false;
+    }
+  _nodes = wf.nodes();
+  _wgt.assign(wf.weights(), wf.weights() + wf.size());
+  _var   = wf.names();
+  _mean  = wf.mean();
+  _sigma = wf.sigma();
+  _outputType = wf.outputType();
+
+  // Number of layers, nodes per layer and transfer functions, as in _init
+
+  JetnetContext* jn = _context();
+  int nlayer = _nodes.size();
+  jn->mstjn[0] = nlayer;
+  copy(_nodes.begin(), _nodes.end(), &jn->mstjn[9]);
+  jn->mstjn[2] = 2;
+  jn->dat2.igfn[nlayer-2] = _outputType == 0 ? 1 : 4;
+
+  if ( NetworkState::fits(_nodes) )
+    {
+      jn->enter();
+      jninit_();
+      _state.load();
+      jn->leave();
+    }
+  else
+    _state.initialize(*jn);
+  _setweights();
+
+  _status = kSUCCESS;
+  return true;
+}
+
+// Number of patterns in each chunk of the input statistics and of the
+// normalization. The chunk size determines the order of summation.
+const int SCALECHUNK = 4096;
+
 void Jetnet::_findscale()
 {
-  Sample sample=kTRAINING;
-  int npat = _input[sample].size();
-  _mean.clear();
-  _sigma.clear();
-  for (int j = 0; j < _ninput; j++)
+  _wscale = 1;
+  const PatternStore& input = _samples(kTRAINING);
+  int npat = input.size();
+
+  // Weights are scaled to a mean of 1, so that the learning rate does
+  // not depend on their normalization
+
+  if ( input.weighted() )
     {
-      _mean.push_back(0);
-      _sigma.push_back(0);
+      double sumw = 0;
+      for (int p = 0; p < npat; p++) sumw += input.weight(p);
+      if ( sumw > 0 ) _wscale = npat / sumw;
     }
 
-  for (int p = 0; p < npat; p++)
+  if ( _stream )
     {
+      // Make one pass through the files of the training stream
+
+      vdouble mean, var;
+      double meanw = _stream->moments(mean, var);
+      if ( meanw > 0 ) _wscale = 1 / meanw;
+      _mean.clear();
+      _sigma.clear();
       for (int j = 0; j < _ninput; j++)
 	{
-	  float x = _input[sample][p][j];
-	  _mean[j]  += x;
-	  _sigma[j] += x*x;
+	  _mean.push_back(mean[j]);
+	  _sigma.push_back((var[j] + mean[j] * mean[j]) / sqrt(var[j]));
 	}
+      return;
     }
 
+  // Mean and sum of squared deviations of each input, in double
+  // precision, per chunk of patterns (Welford's update), merged in
+  // chunk order (Chan et al.), so that the result does not depend on
+  // the number of threads
+
+  int nchunk = (npat + SCALECHUNK - 1) / SCALECHUNK;
+  vvdouble cmean(nchunk), cm2(nchunk);
+  _threadpool()->run(nchunk, [&](int chunk, int thread)
+    {
+      int first = chunk * SCALECHUNK;
+      int count = min(SCALECHUNK, npat - first);
+      vdouble& m  = cmean[chunk];
+      vdouble& m2 = cm2[chunk];
+      m.assign(_ninput, 0);
+      m2.assign(_ninput, 0);
+      for (int p = 0; p < count; p++)
+	{
+	  const float* row = input.row(first + p);
+	  double inv = 1.0 / (p + 1);
+	  for (int j = 0; j < _ninput; j++)
+	    {
+	      double d = row[j] - m[j];
+	      m[j]  += d * inv;
+	      m2[j] += d * (row[j] - m[j]);
+	    }
+	}
+    });
+
+  vdouble mean(_ninput, 0), m2(_ninput, 0);
+  double n = 0;
+  for (int c = 0; c < nchunk; c++)
+    {
+      double nc = min(SCALECHUNK, npat - c * SCALECHUNK);
+      double nt = n + nc;
+      for (int j = 0; j < _ninput; j++)
+	{
+	  double d = cmean[c][j] - mean[j];
+	  mean[j] += d * nc / nt;
+	  m2[j]   += cm2[c][j] + d * d * n * nc / nt;
+	}
+      n = nt;
+    }
+
+  // The scale is the mean square over the standard deviation, as for
+  // streams
+
+  _mean.clear();
+  _sigma.clear();
   for (int j = 0; j < _ninput; j++)
     {
-      _mean[j]  /= npat;
-      _sigma[j] /= npat;
-      _sigma[j] /= sqrt(_sigma[j] - _mean[j] * _mean[j]);
+      double var    = npat > 0 ? m2[j] / npat : 0;
+      double meansq = var + mean[j] * mean[j];
+      _mean.push_back(mean[j]);
+      _sigma.push_back(npat > 0 ? meansq / sqrt(var) : 1);
     }
 }
 
-void Jetnet::_setpattern(Sample sample)
+// Normalize the inputs of the training and testing samples once, for
+// train() and test()
+
+void Jetnet::_normalize()
 {
-  _status = kSUCCESS;
-  if ( _input.find(sample) == _input.end() )
+  _normalized.clear();
+  if ( ! _prenormalize || _mean.size() != (size_t)_ninput ) return;
+
+  for (int s = 0; s < 2; s++)
     {
-      _status = kBADSAMPLE;
+      Sample sample = s == 0 ? kTRAINING : kTESTING;
+      if ( sample == kTRAINING && _stream ) continue;
+      if ( _input.find(sample)  == _input.end() &&
+	   _shared.find(sample) == _shared.end() ) continue;
+      const PatternStore& input = _samples(sample);
+      int npat = input.size();
+      if ( npat == 0 ) continue;
+
+      // Copy the sample, then normalize the copy in place
+
+      vint columns(_ninput);
+      for (int j = 0; j < _ninput; j++) columns[j] = j;
+      PatternStore& store = _normalized[sample];
+      store = PatternStore(_ninput);
+      store.reserve(npat);
+      store.add(input.data(), npat, input.stride(), &columns[0], 
+		input.targets(), input.weights());
+
+      int nchunk = (npat + SCALECHUNK - 1) / SCALECHUNK;
+      _threadpool()->run(nchunk, [&](int chunk, int thread)
+	{
+	  int first = chunk * SCALECHUNK;
+	  int last  = min(first + SCALECHUNK, npat);
+	  for (int p = first; p < last; p++)
+	    {
+	      float* row = store.row(p);
+	      for (int j = 0; j < _ninput; j++)
+		row[j] = (row[j] - _mean[j]) / _sigma[j];
+	    }
+	});
+    }
+}
+
+// Return the normalized copy of a sample, or 0 if there is none
+
+const PatternStore* Jetnet::_normalizedSample(Sample sample)
+{
+  map<Sample, PatternStore>::iterator it = _normalized.find(sample);
+  if ( it == _normalized.end() ) return 0;
+  if ( it->second.size() != _samples(sample).size() ) return 0;
+  return &it->second;
+}
+
+// Copy current weights into _wgt, using the same ordering as 
+// jnDumpWeightsMLP
+
+void Jetnet::_getweights()
+{
+  _state.weights(_wgt);
+}
+
+// Make _wgt the current weights (inverse of _getweights)
+
+void Jetnet::_setweights()
+{
+  _state.setWeights(_wgt);
+}
+
+// Rebuild network function from the current weights. The inverse 
+// temperature of each layer is folded into its weights, as in JNFEED.
+
+void Jetnet::_compile()
+{
+  _getweights();
+
+  JetnetContext* jn = _context();
+  vdouble wgt(_wgt.size());
+  int k = 0;
+  for (int l = 1; l < (int)_nodes.size(); l++)
+    {
+      double beta = jn->dat2.tinv[l-1] == 0 
+	? jn->parjn[2] 
+	: fabs(jn->dat2.tinv[l-1]);
+      for (int i = 0; i < _nodes[l] * (_nodes[l-1] + 1); i++, k++)
+	wgt[k] = beta == 1 ? _wgt[k] : beta * _wgt[k];
+    }
+  _network = CompiledNetwork(_nodes, wgt, _mean, _sigma, _outputType);
+  if ( _table ) _tabulated = _network.tabulated(_table);
+}
+
+// Seed the permutation of the training patterns and draw the order
+// of the first epoch
+
+void Jetnet::_shuffling()
+{
+  if ( _order == 0 ) _order = new Permutation();
+
+  _order->seed(_seed());
+  _order->shuffle(_samples(_sample).size(), _shuffleBlock);
+}
+
+// Seed of a permutation: the shuffling seed if set, else 48 bits from
+// the random numbers of this network, so that the permutation does not
+// depend on other networks
+
+unsigned long long Jetnet::_seed()
+{
+  unsigned long long seed = _shuffleSeed;
+  if ( seed == 0 )
+    {
+      JetnetContext* jn = _context();
+      for (int k = 0; k < 2; k++)
+	seed = (seed << 24) | (unsigned long long)(jn->rjn() * (1 << 24));
+    }
+  return seed;
+}
+
+// Build the alias table of the training weights, if resampling
+
+void Jetnet::_resampling()
+{
+  delete _alias;
+  _alias = 0;
+  if ( ! _resample ) return;
+  if ( _stream )
+    {
+      cout << "Jetnet::begin: resampling does not apply to streams" << endl;
+      return;
+    }
+
+  const PatternStore& input = _samples(kTRAINING);
+  size_t npat = input.size();
+  vfloat weights(npat);
+  for (size_t p = 0; p < npat; p++) weights[p] = input.weight(p);
+
+  _alias = new AliasTable();
+  if ( ! _alias->build(weights.data(), npat) )
+    {
+      cout << "Jetnet::begin: no positive training weights to resample"
+	   << endl;
+      delete _alias;
+      _alias = 0;
+    }
+}
+
+// Train on the patterns of input, or on the given rows of input; 
+// draws are unweighted. The inputs of a normalized store are used as
+// they are.
+
+void Jetnet::_train(const PatternStore& input, const vint* rows, bool draws,
+		    bool normalized)
+{
+  JetnetContext* jn = _context();
+  if ( _native && BackProp::supported(*jn) )
+    {
+      if ( _backprop == 0 ) _backprop = new BackProp();
+      vfloat none;
+      _backprop->train(*jn, _state, input, 
+		       normalized ? none : _mean, normalized ? none : _sigma,
+		       _threadpool(),
+		       draws ? 0 : _wscale, rows, &_epochStats);
+      _epochStats._patterns += rows ? rows->size() : input.size();
+      return;
+    }
+
+  if ( !draws && input.weighted() )
+    {
+      cout << "Jetnet::train: weighted patterns cannot be trained with method "
+	   << jn->mstjn[4] << endl;
+      _status = kFAILURE;
       return;
     }
 
-  int npat = _input[sample].size();
+  if ( !_state.fits() )
+    {
+      cout << "Jetnet::train: network too large for method " 
+	   << jn->mstjn[4] << endl;
+      _status = kFAILURE;
+      return;
+    }
 
-  // Randomize order of patterns
+  // JETNET routines use the common blocks, which are shared by all
+  // networks
 
-  vector<int> rows(npat);
-  for (int i = 0; i < npat; i++) rows[i] = i;
-  random_shuffle(rows.begin(), rows.end());
+  jn->enter();
+  _state.store();
 
-  // Copy to temporary buffers
+  // Training loop 
+ 
+  // The calls of JNTRAL that update the weights are timed one by one,
+  // the others together
 
-  vvfloat ibuff(npat);
-  vfloat  obuff(npat);
+  TrainingStats& stats = _epochStats;
+  int  ppu    = jndat1_.mstjn[1];
+  int  method = jndat1_.mstjn[4];
+  int  steps  = 0;
+  double t    = TrainingStats::clock();
 
-  for (int i = 0; i < npat; i++)
+  int npat = rows ? (int)rows->size() : (int)input.size();
+  for (int i=0; i < npat; i++ )
     {
-      int p = rows[i];
-      ibuff[i] = vfloat(_ninput);
+      int p = rows ? (*rows)[i] : i;
+
+      // load pattern into array oin(*) 
+
+      const float* row = input.row(p);
+      if ( normalized )
+	for (int j=0; j < _ninput; j++) jndat1_.oin[j] = row[j];
+      else
+	for (int j=0; j < _ninput; j++)
+	  jndat1_.oin[j] = (row[j] - _mean[j]) / _sigma[j];
+
+      // load target into array out(*) 
+
+      jndat1_.out[0] = input.target(p);
+	   
+      // apply training algorithm 
 
-      copy(_input[sample][p].begin(),
-	   _input[sample][p].end(), ibuff[i].begin());  
+      if ( (jndat1_.mstjn[6] + 1) % ppu != 0 )
+	{
+	  jntral_();
+	  continue;
+	}
 
-      obuff[i] = _output[sample][p];
-    } 
+      double t1 = TrainingStats::clock();
+      stats._time[TrainingStats::kJETNET] += t1 - t;
+      jntral_();
+      t = TrainingStats::clock();
+      stats._time[TrainingStats::kUPDATE] += t - t1;
+      stats._updates++;
 
-  // Copy back randomized patterns from temporary buffers
+      // Conjugate gradient methods take one line-search step per
+      // update; the search is over when ILINON is reset
 
-  copy(ibuff.begin(), ibuff.end(), _input[sample].begin());
-  copy(obuff.begin(), obuff.end(), _output[sample].begin());
+      if ( method >= 4 && method <= 8 )
+	{
+	  stats._iterations++;
+	  steps++;
+	  if ( jnint4_.ilinon == 0 )
+	    {
+	      stats._searches++;
+	      stats._longest = max(stats._longest, steps);
+	      steps = 0;
+	    }
+	}
+    } // End of training loop
+
+  stats._time[TrainingStats::kJETNET] += TrainingStats::clock() - t;
+  stats._patterns += npat;
+
+  _state.load();
+  jn->leave();
 }
 
 void Jetnet::_init(string vars, int hidden, Output outType)
@@ -732,6 +1723,8 @@ void Jetnet::_init(string vars, int hidden, Output outType)
   a.index = 9; _id["inputNodes"]        = a;
   a.index =30; _id["warningProcedure"]  = a;
   a.index =31; _id["maximumWarnings"]   = a;
+  a.index =34; _id["maximumIterations"] = a;
+  a.index =35; _id["maximumRestarts"]   = a;
 
   a.type  = 4;
   a.index = 0; _id["outputType"] = a;
@@ -758,11 +1751,8 @@ void Jetnet::_init(string vars, int hidden, Output outType)
 
       jtn::split(vars.c_str(), _var);
 
-      _input[kTRAINING] = vector<vfloat>();
-      _input[kTESTING]  = vector<vfloat>();
-      
-      _output[kTRAINING]= vector<float>();
-      _output[kTESTING] = vector<float>();
+      _input[kTRAINING] = PatternStore(_var.size());
+      _input[kTESTING]  = PatternStore(_var.size());
 
       // Set up vector of node counts
       _nodes.clear();
@@ -778,13 +1768,14 @@ void Jetnet::_init(string vars, int hidden, Output outType)
 
   if ( vars != "" )
     {
+      JetnetContext* jn = _context();
       int loc;
-      loc = _id["numberLayers"].index; jndat1_.mstjn[loc] = _nlayer;  
+      loc = _id["numberLayers"].index; jn->mstjn[loc] = _nlayer;  
       loc = _id["inputNodes"].index;
-      copy(_nodes.begin(), _nodes.end(), &jndat1_.mstjn[loc]);
+      copy(_nodes.begin(), _nodes.end(), &jn->mstjn[loc]);
       
-      jndat1_.mstjn[34] = 50; // Max. iterations allowed in line search
-      jndat1_.mstjn[35] = 50; // Max. allowed restarts in line search.
+      jn->mstjn[34] = 50; // Max. iterations allowed in line search
+      jn->mstjn[35] = 50; // Max. allowed restarts in line search.
 
       // Determine sigmoid functions to use
   
@@ -795,19 +1786,19 @@ void Jetnet::_init(string vars, int hidden, Output outType)
       
       // Hard-code internal transfer function
   
-      jndat1_.mstjn[2] = 2; // Sigmoid output
+      jn->mstjn[2] = 2; // Sigmoid output
       
       // Determine output node type
       
       if ( outType == kSIGMOID )
 	{
 	  _outputType = 0;
-	  jndat2_.igfn[_nlayer-2] = 1; // Sigmoid output
+	  jn->dat2.igfn[_nlayer-2] = 1; // Sigmoid output
 	}
       else
 	{
 	  _outputType = 1;
-	  jndat2_.igfn[_nlayer-2] = 4; // Linear output
+	  jn->dat2.igfn[_nlayer-2] = 4; // Linear output
 	}
     }
 }
@@ -817,16 +1808,17 @@ void Jetnet::_setParameter(string name)
   if ( _id.find(name) == _id.end() ) return;
   if ( !_id[name].set ) return;
 
+  JetnetContext* jn = _context();
   if      ( _id[name].type == 0 )
-    jndat1_.mstjn[_id[name].index] = (int)_id[name].value;
+    jn->mstjn[_id[name].index] = (int)_id[name].value;
   else if ( _id[name].type == 1 )
-    jndat1_.parjn[_id[name].index] = _id[name].value;
+    jn->parjn[_id[name].index] = _id[name].value;
 }
 
 
 // Write out C++ function
 
-void Jetnet::_saveCPP(string filename)
+void Jetnet::_saveCPP(string filename, Code code)
 {
   filename = filename + ".cpp";
 
@@ -840,7 +1832,9 @@ void Jetnet::_saveCPP(string filename)
 		 _var,
 		 _mean,
 		 _sigma,
-		 _outputType) == 0 )
+		 _outputType,
+		 code == kARRAYS,
+		 _table ? _table->intervals() : 0) == 0 )
     _status = kSUCCESS;
   else
     _status = kFAILURE;
@@ -0,0 +1,181 @@
+//-----------------------------------------------------------------------------
+// File: JetnetContext.cc
+// Purpose: Per-instance copy of the JETNET switches, parameters and state
+// Created: 18-Oct-2026
+//-----------------------------------------------------------------------------
+#include <string.h>
+#include <cmath>
+#include <mutex>
+
+#include "JetnetContext.h"
+
+using namespace std;
+
+namespace {
+  // Guards the JETNET common blocks
+  mutex& commonMutex()
+  {
+    static mutex m;
+    return m;
+  }
+};
+
+JetnetContext::JetnetContext()
+{
+  lock_guard<mutex> lock(commonMutex());
+
+  // The first context records the defaults set by BLOCK DATA, before
+  // any context has been copied into the common blocks
+
+  static JetnetContext* defaults = 0;
+  if ( defaults == 0 )
+    {
+      _load();
+      defaults = new JetnetContext(*this);
+    }
+  else
+    *this = *defaults;
+}
+
+void JetnetContext::enter()
+{
+  commonMutex().lock();
+  _store();
+}
+
+void JetnetContext::leave()
+{
+  _load();
+  commonMutex().unlock();
+}
+
+void JetnetContext::_load()
+{
+  memcpy(mstjn, jndat1_.mstjn, sizeof(mstjn));
+  memcpy(parjn, jndat1_.parjn, sizeof(parjn));
+  memcpy(mstjm, jndat1_.mstjm, sizeof(mstjm));
+  memcpy(parjm, jndat1_.parjm, sizeof(parjm));
+  mxndjm = jndat1_.mxndjm;
+  dat2 = jndat2_;
+  int2 = jnint2_;
+  int3 = jnint3_;
+  int4 = jnint4_;
+  datr = jndatr_;
+  gaus = jngaus_;
+}
+
+void JetnetContext::_store() const
+{
+  memcpy(jndat1_.mstjn, mstjn, sizeof(mstjn));
+  memcpy(jndat1_.parjn, parjn, sizeof(parjn));
+  memcpy(jndat1_.mstjm, mstjm, sizeof(mstjm));
+  memcpy(jndat1_.parjm, parjm, sizeof(parjm));
+  jndat1_.mxndjm = mxndjm;
+  jndat2_ = dat2;
+  jnint2_ = int2;
+  jnint3_ = int3;
+  jnint4_ = int4;
+  jndatr_ = datr;
+  jngaus_ = gaus;
+}
+
+// Marsaglia-Zaman-Tsang generator, transcribed from RJN
+
+float JetnetContext::rjn()
+{
+  int*   mrjn = datr.mrjn;
+  float* rrjn = datr.rrjn - 1;   // Fortran indexing
+
+  // Initialize generation from given seed
+
+  if ( mrjn[1] == 0 )
+    {
+      int ij = (mrjn[0] / 30082) % 31329;
+      int kl = mrjn[0] % 30082;
+      int i = (ij / 177) % 177 + 2;
+      int j = ij % 177 + 2;
+      int k = (kl / 169) % 178 + 1;
+      int l = kl % 169;
+      for (int ii = 1; ii <= 97; ii++)
+	{
+	  float s = 0;
+	  float t = 0.5f;
+	  for (int jj = 1; jj <= 24; jj++)
+	    {
+	      int m = ((i * j) % 179 * k) % 179;
+	      i = j;
+	      j = k;
+	      k = m;
+	      l = (53 * l + 1) % 169;
+	      if ( (l * m) % 64 >= 32 ) s = s + t;
+	      t = 0.5f * t;
+	    }
+	  rrjn[ii] = s;
+	}
+      float twom24 = 1;
+      for (int i24 = 1; i24 <= 24; i24++) twom24 = 0.5f * twom24;
+      rrjn[98]  = 362436.0f   * twom24;
+      rrjn[99]  = 7654321.0f  * twom24;
+      rrjn[100] = 16777213.0f * twom24;
+      mrjn[1] = 1;
+      mrjn[2] = 0;
+      mrjn[3] = 97;
+      mrjn[4] = 33;
+    }
+
+  // Generate next random number
+
+  float runi;
+  do
+    {
+      runi = rrjn[mrjn[3]] - rrjn[mrjn[4]];
+      if ( runi < 0 ) runi = runi + 1;
+      rrjn[mrjn[3]] = runi;
+      mrjn[3]--;
+      if ( mrjn[3] == 0 ) mrjn[3] = 97;
+      mrjn[4]--;
+      if ( mrjn[4] == 0 ) mrjn[4] = 97;
+      rrjn[98] = rrjn[98] - rrjn[99];
+      if ( rrjn[98] < 0 ) rrjn[98] = rrjn[98] + rrjn[100];
+      runi = runi - rrjn[98];
+      if ( runi < 0 ) runi = runi + 1;
+    }
+  while ( runi <= 0 || runi >= 1 );
+
+  // Update counters
+
+  mrjn[2]++;
+  if ( mrjn[2] == 1000000000 )
+    {
+      mrjn[1]++;
+      mrjn[2] = 0;
+    }
+  return runi;
+}
+
+// Polar method, transcribed from GAUSJN
+
+float JetnetContext::gausjn()
+{
+  const float TINY = 1.e-20f;
+
+  if ( gaus.iset != 0 )
+    {
+      gaus.iset = 0;
+      return gaus.gasdev;
+    }
+
+  float v1, v2, r;
+  do
+    {
+      v1 = 2 * rjn() - 1;
+      v2 = 2 * rjn() - 1;
+      r  = v1 * v1 + v2 * v2;
+    }
+  while ( r >= 1 || r <= TINY );
+
+  float fac = sqrt(-2 * log(r) / r);
+  gaus.gasdev = v2 * fac;
+  gaus.iset   = 1;
+  return v1 * fac;
+}
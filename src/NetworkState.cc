@@ -0,0 +1,185 @@
+//-----------------------------------------------------------------------------
+// File: NetworkState.cc
+// Purpose: Heap-allocated weights and thresholds of a JETNET network
+// Created: 18-Oct-2026
+//-----------------------------------------------------------------------------
+#include <algorithm>
+
+#include "JetnetContext.h"
+#include "NetworkState.h"
+
+using namespace std;
+
+// Maximum number of layers (excluding the inputs), set by the size
+// of the per-layer arrays of /JNDAT2/ and /JNINT2/
+const int MAXL = 10;
+
+NetworkState::NetworkState()
+  : nl(0),
+    nw(0),
+    nt(0)
+{}
+
+bool NetworkState::fits(const vector<int>& nodes)
+{
+  int nlayer = (int)nodes.size() - 1;
+  if ( nlayer < 1 || nlayer > MAXL ) return false;
+  if ( nodes[0] > MAXI || nodes[nlayer] > MAXO ) return false;
+
+  long nv = 0;
+  long nm = 0;
+  for (int l = 1; l <= nlayer; l++)
+    {
+      nv += nodes[l];
+      nm += (long)nodes[l] * nodes[l-1];
+    }
+  return nv <= MAXV && nm <= MAXM;
+}
+
+bool NetworkState::fits() const
+{
+  return fits(m);
+}
+
+// Offsets of thresholds and weights of each layer, as in JNSEPA
+
+void NetworkState::_layout(const vector<int>& nodes)
+{
+  nl  = (int)nodes.size() - 1;
+  m   = nodes;
+  mv0 = vector<int>(nl + 1, 0);
+  mm0 = vector<int>(nl + 1, 0);
+  for (int l = 1; l <= nl; l++)
+    {
+      mv0[l] = mv0[l-1] + m[l];
+      mm0[l] = mm0[l-1] + m[l] * m[l-1];
+    }
+  nt = mv0[nl];
+  nw = mm0[nl];
+}
+
+void NetworkState::initialize(JetnetContext& jn)
+{
+  int*   mstjn = jn.mstjn;
+  float* parjn = jn.parjn;
+
+  int nlayer = mstjn[0] - 1;
+  if ( nlayer < 1 || nlayer > MAXL ) return;
+
+  _layout(vector<int>(&mstjn[9], &mstjn[9] + nlayer + 1));
+
+  // Transfer functions (JNSEPA)
+
+  jn.int2.ipott = mstjn[3];
+  if ( mstjn[3] == 1 ) jn.dat2.igfn[nl-1] = 5;
+
+  ng.resize(nl);
+  for (int l = 0; l < nl; l++)
+    ng[l] = jn.dat2.igfn[l] == 0 ? mstjn[2] : jn.dat2.igfn[l];
+
+  // Layout of /JNINT2/, which the JETNET parameter routines use
+
+  jn.int2.nl = nl;
+  for (int l = 0; l <= nl; l++)
+    {
+      jn.int2.m[l]   = m[l];
+      jn.int2.mv0[l] = mv0[l];
+      jn.int2.mm0[l] = mm0[l];
+    }
+  copy(ng.begin(), ng.end(), jn.int2.ng);
+  jn.int2.icpon = (mstjn[27] > 0 || mstjn[28] > 0 || mstjn[29] > 0) ? 1 : 0;
+
+  dw = vector<float>(nw, 0);
+  dt = vector<float>(nt, 0);
+  nself  = vector<int>(nw, 1);
+  ntself = vector<int>(nt, 1);
+  w.resize(nw);
+  t.resize(nt);
+  g.clear();
+  odw.clear();
+  odt.clear();
+  etav.clear();
+
+  // Random weights and thresholds, drawn in the same order as JNINIT
+
+  for (int l = 1; l <= nl; l++)
+    {
+      float width = jn.dat2.widl[l-1] <= 0 ? parjn[3] : jn.dat2.widl[l-1];
+      for (int i = mm0[l-1]; i < mm0[l]; i++)
+	{
+	  w[i] = width >= 0 ? (2 * jn.rjn() - 1) * width : -jn.rjn() * width;
+	}
+      for (int i = mv0[l-1]; i < mv0[l]; i++)
+	{
+	  t[i] = width >= 0 ? (2 * jn.rjn() - 1) * width : -jn.rjn() * width;
+	}
+    }
+
+  mstjn[7]  = 1;  // Initialized
+  mstjn[37] = 0;
+}
+
+void NetworkState::load()
+{
+  nl  = jnint2_.nl;
+  m   = vector<int>(jnint2_.m,   jnint2_.m   + nl + 1);
+  mv0 = vector<int>(jnint2_.mv0, jnint2_.mv0 + nl + 1);
+  mm0 = vector<int>(jnint2_.mm0, jnint2_.mm0 + nl + 1);
+  ng  = vector<int>(jnint2_.ng,  jnint2_.ng  + nl);
+  nw  = mm0[nl];
+  nt  = mv0[nl];
+
+  w  = vector<float>(jnint1_.w,  jnint1_.w  + nw);
+  dw = vector<float>(jnint1_.dw, jnint1_.dw + nw);
+  t  = vector<float>(jnint1_.t,  jnint1_.t  + nt);
+  dt = vector<float>(jnint1_.dt, jnint1_.dt + nt);
+  nself  = vector<int>(jnint1_.nself,  jnint1_.nself  + nw);
+  ntself = vector<int>(jnint1_.ntself, jnint1_.ntself + nt);
+
+  g    = vector<float>(jnint1_.g,    jnint1_.g    + nw + nt);
+  odw  = vector<float>(jnint1_.odw,  jnint1_.odw  + nw);
+  odt  = vector<float>(jnint1_.odt,  jnint1_.odt  + nt);
+  etav = vector<float>(jnint1_.etav, jnint1_.etav + nw + nt);
+}
+
+void NetworkState::store() const
+{
+  if ( !fits() ) return;
+  copy(w.begin(),  w.end(),  jnint1_.w);
+  copy(dw.begin(), dw.end(), jnint1_.dw);
+  copy(t.begin(),  t.end(),  jnint1_.t);
+  copy(dt.begin(), dt.end(), jnint1_.dt);
+  copy(nself.begin(),  nself.end(),  jnint1_.nself);
+  copy(ntself.begin(), ntself.end(), jnint1_.ntself);
+  copy(g.begin(),    g.end(),    jnint1_.g);
+  copy(odw.begin(),  odw.end(),  jnint1_.odw);
+  copy(odt.begin(),  odt.end(),  jnint1_.odt);
+  copy(etav.begin(), etav.end(), jnint1_.etav);
+}
+
+void NetworkState::weights(vector<double>& weight) const
+{
+  weight.clear();
+  weight.reserve(nw + nt);
+  for (int l = 1; l <= nl; l++)
+    for (int i = 0; i < m[l]; i++)
+      {
+	weight.push_back(t[mv0[l-1] + i]);
+	for (int j = 0; j < m[l-1]; j++)
+	  weight.push_back(w[mm0[l-1] + j * m[l] + i]);
+      }
+}
+
+void NetworkState::setWeights(const vector<double>& weight)
+{
+  if ( (int)weight.size() != nw + nt ) return;
+
+  int k = 0;
+  for (int l = 1; l <= nl; l++)
+    for (int i = 0; i < m[l]; i++)
+      {
+	t[mv0[l-1] + i] = weight[k++];
+	for (int j = 0; j < m[l-1]; j++)
+	  w[mm0[l-1] + j * m[l] + i] = weight[k++];
+      }
+}
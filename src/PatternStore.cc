@@ -0,0 +1,197 @@
+//-----------------------------------------------------------------------------
+// File: PatternStore.cc
+// Purpose: Contiguous storage of training and testing patterns
+// Created: 18-Oct-2026
+//-----------------------------------------------------------------------------
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+#include <algorithm>
+
+#include "PatternStore.h"
+
+using namespace std;
+
+namespace {
+  float* allocate(size_t nfloats)
+  {
+    if ( nfloats == 0 ) return 0;
+    void* p = 0;
+    if ( posix_memalign(&p, PatternStore::ALIGN, nfloats * sizeof(float)) )
+      throw bad_alloc();
+    return (float*)p;
+  }
+};
+
+PatternStore::PatternStore(int ncolumns, bool aligned)
+  : _ncolumns(ncolumns),
+    _stride(ncolumns),
+    _size(0),
+    _capacity(0),
+    _data(0)
+{
+  if ( aligned )
+    {
+      // Pad rows to a multiple of ALIGN bytes
+      const size_t n = ALIGN / sizeof(float);
+      _stride = ((_ncolumns + n - 1) / n) * n;
+    }
+}
+
+PatternStore::PatternStore(const PatternStore& other)
+  : _ncolumns(other._ncolumns),
+    _stride(other._stride),
+    _size(0),
+    _capacity(0),
+    _data(0)
+{
+  *this = other;
+}
+
+PatternStore& PatternStore::operator=(const PatternStore& other)
+{
+  if ( this == &other ) return *this;
+  free(_data);
+  _ncolumns = other._ncolumns;
+  _stride   = other._stride;
+  _size     = other._size;
+  _capacity = other._size;
+  _data     = allocate(_capacity * _stride);
+  if ( _size > 0 ) memcpy(_data, other._data, _size * _stride * sizeof(float));
+  _target   = other._target;
+  _weight   = other._weight;
+  return *this;
+}
+
+PatternStore::~PatternStore()
+{
+  free(_data);
+}
+
+void PatternStore::reserve(size_t npatterns)
+{
+  if ( npatterns <= _capacity ) return;
+  float* data = allocate(npatterns * _stride);
+  if ( _size > 0 ) memcpy(data, _data, _size * _stride * sizeof(float));
+  free(_data);
+  _data = data;
+  _capacity = npatterns;
+  _target.reserve(npatterns);
+  if ( weighted() ) _weight.reserve(npatterns);
+}
+
+float* PatternStore::_grow()
+{
+  if ( _size == _capacity ) reserve(_capacity > 0 ? 2 * _capacity : 1024);
+  float* p = row(_size);
+  fill(p + _ncolumns, p + _stride, 0.0f);
+  _size++;
+  return p;
+}
+
+// Record weights of the n patterns starting at first. Weights are
+// stored only from the first weight that differs from 1.
+
+template <class T>
+void PatternStore::_addWeights(size_t first, size_t n, const T* weights)
+{
+  if ( _weight.empty() )
+    {
+      if ( weights == 0 ) return;
+      size_t i = 0;
+      while ( i < n && weights[i] == 1 ) i++;
+      if ( i == n ) return;
+      _weight.reserve(_capacity);
+      _weight.assign(first, 1.0f);
+    }
+  if ( weights == 0 )
+    _weight.insert(_weight.end(), n, 1.0f);
+  else
+    for (size_t i = 0; i < n; i++) _weight.push_back((float)weights[i]);
+}
+
+void PatternStore::add(const float* inp, float target, float weight)
+{
+  float* p = _grow();
+  copy(inp, inp + _ncolumns, p);
+  _target.push_back(target);
+  _addWeights(_size - 1, 1, &weight);
+}
+
+void PatternStore::add(const double* inp, float target, float weight)
+{
+  float* p = _grow();
+  for (int j = 0; j < _ncolumns; j++) p[j] = (float)inp[j];
+  _target.push_back(target);
+  _addWeights(_size - 1, 1, &weight);
+}
+
+template <class T>
+void PatternStore::_add(const T* data, size_t n, size_t stride,
+			const int* columns, const T* targets, const T* weights)
+{
+  if ( _size + n > _capacity ) reserve(max(_size + n, 2 * _capacity));
+
+  for (size_t i = 0; i < n; i++)
+    {
+      const T* inp = data + i * stride;
+      float* p = row(_size + i);
+      for (int j = 0; j < _ncolumns; j++) p[j] = (float)inp[columns[j]];
+      fill(p + _ncolumns, p + _stride, 0.0f);
+      _target.push_back((float)targets[i]);
+    }
+  _addWeights(_size, n, weights);
+  _size += n;
+}
+
+void PatternStore::add(const float* data, size_t n, size_t stride,
+		       const int* columns, const float* targets,
+		       const float* weights)
+{
+  _add(data, n, stride, columns, targets, weights);
+}
+
+void PatternStore::add(const double* data, size_t n, size_t stride,
+		       const int* columns, const double* targets,
+		       const double* weights)
+{
+  _add(data, n, stride, columns, targets, weights);
+}
+
+void PatternStore::add(const float* const* columns, size_t n, float target,
+		       const float* weights)
+{
+  if ( _size + n > _capacity ) reserve(max(_size + n, 2 * _capacity));
+
+  // Transpose in blocks of rows so that both the columns and 
+  // the rows are accessed sequentially
+
+  const size_t block = 256;
+  for (size_t first = 0; first < n; first += block)
+    {
+      size_t last = min(n, first + block);
+      for (int j = 0; j < _ncolumns; j++)
+	{
+	  const float* c = columns[j];
+	  for (size_t i = first; i < last; i++) row(_size + i)[j] = c[i];
+	}
+      for (size_t i = first; i < last; i++)
+	fill(row(_size + i) + _ncolumns, row(_size + i) + _stride, 0.0f);
+    }
+  _target.insert(_target.end(), n, target);
+  _addWeights(_size, n, weights);
+  _size += n;
+}
+
+void PatternStore::remove(size_t i)
+{
+  _size--;
+  if ( i != _size )
+    {
+      memcpy(row(i), row(_size), _stride * sizeof(float));
+      _target[i] = _target[_size];
+      if ( weighted() ) _weight[i] = _weight[_size];
+    }
+  _target.pop_back();
+  if ( weighted() ) _weight.pop_back();
+}
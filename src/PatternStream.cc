@@ -0,0 +1,267 @@
+//-----------------------------------------------------------------------------
+// File: PatternStream.cc
+// Purpose: Stream shuffled training patterns from binary data files
+// Created: 18-Oct-2026
+//-----------------------------------------------------------------------------
+#include <algorithm>
+
+#include "DataFile.h"
+#include "PatternStream.h"
+
+using namespace std;
+
+PatternStream::PatternStream(int ncolumns,
+			     size_t blockSize,
+			     size_t bufferSize,
+			     unsigned int seed)
+  : _ncolumns(ncolumns),
+    _blocksize(blockSize > 0 ? blockSize : 1),
+    _buffersize(bufferSize),
+    _random(seed),
+    _pool(ncolumns),
+    _done(true),
+    _cancel(false)
+{
+  _slot[0] = PatternStore(ncolumns);
+  _slot[1] = PatternStore(ncolumns);
+}
+
+PatternStream::~PatternStream()
+{
+  stop();
+  for (size_t i = 0; i < _sources.size(); i++) delete _sources[i].file;
+}
+
+int PatternStream::add(string filename, float target,
+		       const vector<string>& names,
+		       string weight)
+{
+  DataFile* file = new DataFile(filename);
+  if ( ! file->good() )
+    {
+      delete file;
+      return -1;
+    }
+
+  Source source;
+  source.file   = file;
+  source.target = target;
+  for (int j = 0; j < _ncolumns; j++)
+    {
+      int i = j < (int)names.size() ? file->index(names[j]) : -1;
+      if ( i < 0 )
+	{
+	  delete file;
+	  return -2;
+	}
+      source.columns.push_back(file->column(i));
+    }
+
+  source.weight = 0;
+  if ( weight != "" )
+    {
+      int i = file->index(weight);
+      if ( i < 0 )
+	{
+	  delete file;
+	  return -2;
+	}
+      source.weight = file->column(i);
+    }
+  _sources.push_back(source);
+  return 0;
+}
+
+size_t PatternStream::size() const
+{
+  size_t n = 0;
+  for (size_t i = 0; i < _sources.size(); i++) n += _sources[i].file->rows();
+  return n;
+}
+
+// Rows per block of the moments: Welford's update within a block,
+// Chan's merge between blocks
+const size_t MOMENTBLOCK = 4096;
+
+double PatternStream::moments(vector<double>& mean, vector<double>& variance)
+{
+  mean     = vector<double>(_ncolumns, 0);
+  variance = vector<double>(_ncolumns, 0);
+  vector<double> m2(_ncolumns, 0);
+  double sumw = 0;
+  double n = 0;
+
+  // One column at a time, so that each file is read sequentially
+
+  for (size_t s = 0; s < _sources.size(); s++)
+    {
+      size_t nrows = _sources[s].file->rows();
+      for (int j = 0; j < _ncolumns; j++)
+	{
+	  const float* c = _sources[s].columns[j];
+	  double nj = n;
+	  for (size_t first = 0; first < nrows; first += MOMENTBLOCK)
+	    {
+	      size_t count = min(MOMENTBLOCK, nrows - first);
+	      double bmean = 0, bm2 = 0;
+	      for (size_t i = 0; i < count; i++)
+		{
+		  double x = c[first + i];
+		  double d = x - bmean;
+		  bmean += d / (i + 1);
+		  bm2   += d * (x - bmean);
+		}
+	      double nt = nj + count;
+	      double d  = bmean - mean[j];
+	      mean[j] += d * count / nt;
+	      m2[j]   += bm2 + d * d * nj * count / nt;
+	      nj = nt;
+	    }
+	}
+      n += nrows;
+
+      const float* w = _sources[s].weight;
+      if ( w == 0 )
+	sumw += nrows;
+      else
+	for (size_t i = 0; i < nrows; i++) sumw += w[i];
+    }
+
+  if ( n == 0 ) return 1;
+  for (int j = 0; j < _ncolumns; j++) variance[j] = m2[j] / n;
+  return sumw / n;
+}
+
+void PatternStream::start()
+{
+  stop();
+
+  // Split files into blocks and shuffle the blocks
+
+  _blocks.clear();
+  for (size_t s = 0; s < _sources.size(); s++)
+    {
+      size_t nrows = _sources[s].file->rows();
+      for (size_t first = 0; first < nrows; first += _blocksize)
+	{
+	  Block b;
+	  b.source = s;
+	  b.first  = first;
+	  b.count  = min(_blocksize, nrows - first);
+	  _blocks.push_back(b);
+	}
+    }
+  _order.resize(_blocks.size());
+  for (size_t k = 0; k < _order.size(); k++) _order[k] = k;
+  shuffle(_order.begin(), _order.end(), _random);
+
+  _pool.clear();
+  _pool.reserve(min(size(), _buffersize + _blocksize));
+
+  _filled.clear();
+  _free.clear();
+  _free.push_back(1);
+  _free.push_back(0);
+  _done   = false;
+  _cancel = false;
+  _prefetch = thread(&PatternStream::_produce, this);
+}
+
+void PatternStream::stop()
+{
+  if ( ! _prefetch.joinable() ) return;
+  {
+    lock_guard<mutex> lock(_mutex);
+    _cancel = true;
+  }
+  _changed.notify_all();
+  _prefetch.join();
+}
+
+bool PatternStream::next(PatternStore& chunk)
+{
+  chunk.clear();
+
+  // Top up the shuffle buffer, then draw patterns from it at random.
+  // An empty buffer is always refilled, whatever its size.
+
+  while ( (_pool.size() < _buffersize || _pool.size() == 0) && _fetch() ) {}
+
+  size_t n = min(_blocksize, _pool.size());
+  if ( n == 0 ) return false;
+
+  chunk.reserve(n);
+  for (size_t i = 0; i < n; i++)
+    {
+      uniform_int_distribution<size_t> pick(0, _pool.size() - 1);
+      size_t r = pick(_random);
+      chunk.add(_pool.row(r), _pool.target(r), _pool.weight(r));
+      _pool.remove(r);
+    }
+  return true;
+}
+
+// Runs in the prefetch thread: read blocks, in shuffled order, into
+// whichever slot of the double buffer is free
+
+void PatternStream::_produce()
+{
+  vector<const float*> columns(_ncolumns);
+  for (size_t k = 0; k < _order.size(); k++)
+    {
+      int s;
+      {
+	unique_lock<mutex> lock(_mutex);
+	_changed.wait(lock, [this]{ return _cancel || !_free.empty(); });
+	if ( _cancel ) return;
+	s = _free.back();
+	_free.pop_back();
+      }
+
+      const Block&  b = _blocks[_order[k]];
+      const Source& source = _sources[b.source];
+      for (int j = 0; j < _ncolumns; j++)
+	columns[j] = source.columns[j] + b.first;
+      _slot[s].clear();
+      _slot[s].add(&columns[0], b.count, source.target,
+		   source.weight ? source.weight + b.first : 0);
+
+      {
+	lock_guard<mutex> lock(_mutex);
+	_filled.push_back(s);
+      }
+      _changed.notify_all();
+    }
+
+  {
+    lock_guard<mutex> lock(_mutex);
+    _done = true;
+  }
+  _changed.notify_all();
+}
+
+// Move the next block read by the prefetch thread into the shuffle
+// buffer. Return false when all blocks have been read.
+
+bool PatternStream::_fetch()
+{
+  int s;
+  {
+    unique_lock<mutex> lock(_mutex);
+    _changed.wait(lock, [this]{ return _done || !_filled.empty(); });
+    if ( _filled.empty() ) return false;
+    s = _filled.front();
+    _filled.erase(_filled.begin());
+  }
+
+  const PatternStore& block = _slot[s];
+  for (size_t i = 0; i < block.size(); i++)
+    _pool.add(block.row(i), block.target(i), block.weight(i));
+
+  {
+    lock_guard<mutex> lock(_mutex);
+    _free.push_back(s);
+  }
+  _changed.notify_all();
+  return true;
+}
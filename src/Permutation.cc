@@ -0,0 +1,53 @@
+//-----------------------------------------------------------------------------
+// File: Permutation.cc
+// Purpose: Random order of the patterns of a sample, redrawn every epoch
+// Created: 18-Oct-2026
+//-----------------------------------------------------------------------------
+#include <algorithm>
+
+#include "Permutation.h"
+
+using namespace std;
+
+void Permutation::_shuffle(int* first, size_t n)
+{
+  for (size_t i = n; i > 1; i--)
+    swap(first[i-1], first[below((uint32_t)i)]);
+}
+
+const vector<int>& Permutation::shuffle(size_t n, size_t block)
+{
+  // Any permutation is a valid starting point, so the indices are
+  // reshuffled where they are, unless the size has changed
+
+  if ( block == 0 || block >= n )
+    {
+      if ( _order.size() != n )
+	{
+	  _order.resize(n);
+	  for (size_t i = 0; i < n; i++) _order[i] = (int)i;
+	}
+      _shuffle(_order.data(), n);
+      return _order;
+    }
+
+  // Block-local: random order of the blocks, then of the patterns
+  // within each block
+
+  size_t nblock = (n + block - 1) / block;
+  _order.resize(n);
+  _blocks.resize(nblock);
+  for (size_t b = 0; b < nblock; b++) _blocks[b] = (int)b;
+  _shuffle(_blocks.data(), nblock);
+
+  size_t k = 0;
+  for (size_t b = 0; b < nblock; b++)
+    {
+      size_t first = _blocks[b] * block;
+      size_t count = min(block, n - first);
+      for (size_t i = 0; i < count; i++) _order[k + i] = (int)(first + i);
+      _shuffle(&_order[k], count);
+      k += count;
+    }
+  return _order;
+}
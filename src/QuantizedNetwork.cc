@@ -0,0 +1,728 @@
+//-----------------------------------------------------------------------------
+// File: QuantizedNetwork.cc
+// Purpose: Integer (8- or 16-bit) network function for fast scoring
+// Created: 18-Oct-2026
+//-----------------------------------------------------------------------------
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <stdlib.h>
+
+#include "network.h"
+#include "nnkernel.h"
+#include "ROC.h"
+#include "CompiledNetwork.h"
+#include "QuantizedNetwork.h"
+
+using namespace std;
+
+namespace {
+  // Fraction bits of the position within a table interval
+  const int   FRACTION = 8;
+  const int   ONE      = 1 << FRACTION;
+
+  // The tables cover pre-activations in [-ZMAX, ZMAX]
+  const float ZMAX = 8;
+
+  // Largest layer evaluated with scratch space on the stack
+  const int MAXSTACK = 256;
+
+  // Bound on the thresholds and on the sum of the products of a node,
+  // in accumulator units, so that their total fits in 32 bits
+  const int ACCMAX = (1 << 30) - 1;
+
+  // Round to the nearest integer in [-qmax, qmax]
+
+  inline int quantize(float t, int qmax)
+  {
+    t = t < -qmax ? -qmax : (t > qmax ? qmax : t);
+    return (int)(t + (t >= 0 ? 0.5f : -0.5f));
+  }
+
+  // Position of a pre-activation in a table of n intervals: u is in
+  // units of 1/ONE of an interval, counted from -ZMAX
+
+  inline int position(float u, int n)
+  {
+    float top = (float)(n * ONE - 1);
+    u = u < 0 ? 0 : (u > top ? top : u);
+    return (int)u;
+  }
+
+  inline int interpolate(const int* table, int u)
+  {
+    int k = u >> FRACTION;
+    int f = u & (ONE - 1);
+    return table[k] + (((table[k+1] - table[k]) * f) >> FRACTION);
+  }
+
+  inline float interpolate(const float* table, int u)
+  {
+    int k = u >> FRACTION;
+    int f = u & (ONE - 1);
+    return table[k] + (table[k+1] - table[k]) * (f * (1.0f / ONE));
+  }
+
+  // Write an array as a C++ initializer
+
+  template <class T>
+  void writearray(ostream& out, string type, string name,
+		  const T* x, size_t n, string suffix="")
+  {
+    out << "  const " << type << " " << name << "[" << n << "] = {";
+    for (size_t i = 0; i < n; i++)
+      {
+	if ( i % 8 == 0 ) out << "\n    ";
+	out << x[i] << suffix << (i + 1 < n ? ", " : "");
+      }
+    out << "};\n";
+  }
+};
+
+#if defined(__GNUC__)
+#define NNINLINE inline __attribute__((always_inline))
+#else
+#define NNINLINE inline
+#endif
+
+// Sums of a layer for a block of NNBLOCK patterns stored node-major:
+// a[i][b] = bias[i] + sum_j w[i][j] y[j][b], in 32-bit integers.
+// Compiled once per instruction set below.
+
+template <class Q>
+static NNINLINE void layersums(int nin, int nout, 
+			       const Q* __restrict__ w,
+			       const int* __restrict__ bias,
+			       const Q* __restrict__ y,
+			       int* __restrict__ a)
+{
+  for (int i = 0; i < nout; i++)
+    {
+      int* __restrict__ ai = a + i * NNBLOCK;
+      for (int b = 0; b < NNBLOCK; b++) ai[b] = bias[i];
+      for (int j = 0; j < nin; j++)
+	{
+	  int wij = w[i * nin + j];
+	  const Q* __restrict__ yj = y + j * NNBLOCK;
+	  for (int b = 0; b < NNBLOCK; b++) ai[b] += wij * (int)yj[b];
+	}
+    }
+}
+
+namespace {
+  typedef void (*Layer8) (int, int, const signed char*, const int*,
+			  const signed char*, int*);
+  typedef void (*Layer16)(int, int, const short*, const int*,
+			  const short*, int*);
+
+  struct QKernels
+  {
+    const char* isa;
+    Layer8      layer8;
+    Layer16     layer16;
+  };
+
+  void layer8_generic(int nin, int nout, const signed char* w, 
+		      const int* bias, const signed char* y, int* a)
+  { layersums(nin, nout, w, bias, y, a); }
+
+  void layer16_generic(int nin, int nout, const short* w,
+		       const int* bias, const short* y, int* a)
+  { layersums(nin, nout, w, bias, y, a); }
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define NNDISPATCH
+
+  __attribute__((target("avx2")))
+  void layer8_avx2(int nin, int nout, const signed char* w, 
+		   const int* bias, const signed char* y, int* a)
+  { layersums(nin, nout, w, bias, y, a); }
+
+  __attribute__((target("avx2")))
+  void layer16_avx2(int nin, int nout, const short* w,
+		    const int* bias, const short* y, int* a)
+  { layersums(nin, nout, w, bias, y, a); }
+
+  __attribute__((target("avx512f,avx512bw")))
+  void layer8_avx512(int nin, int nout, const signed char* w, 
+		     const int* bias, const signed char* y, int* a)
+  { layersums(nin, nout, w, bias, y, a); }
+
+  __attribute__((target("avx512f,avx512bw")))
+  void layer16_avx512(int nin, int nout, const short* w,
+		      const int* bias, const short* y, int* a)
+  { layersums(nin, nout, w, bias, y, a); }
+#endif
+
+  // Select the widest instruction set supported by the processor, as
+  // for the float kernels (see nnkernel.cc)
+
+  QKernels select()
+  {
+    QKernels k = {"generic", layer8_generic, layer16_generic};
+#ifdef NNDISPATCH
+    __builtin_cpu_init();
+    if ( getenv("JETNET_NOSIMD") != 0 ) return k;
+    if ( __builtin_cpu_supports("avx512bw") )
+      {
+	k.isa = "avx512bw";
+	k.layer8  = layer8_avx512;
+	k.layer16 = layer16_avx512;
+      }
+    else if ( __builtin_cpu_supports("avx2") )
+      {
+	k.isa = "avx2";
+	k.layer8  = layer8_avx2;
+	k.layer16 = layer16_avx2;
+      }
+#endif
+    return k;
+  }
+
+  const QKernels& qkernels()
+  {
+    static const QKernels k = select();
+    return k;
+  }
+
+  inline void qlayer(int nin, int nout, const signed char* w,
+		     const int* bias, const signed char* y, int* a)
+  {
+    qkernels().layer8(nin, nout, w, bias, y, a);
+  }
+
+  inline void qlayer(int nin, int nout, const short* w,
+		     const int* bias, const short* y, int* a)
+  {
+    qkernels().layer16(nin, nout, w, bias, y, a);
+  }
+};
+
+QuantizedNetwork::QuantizedNetwork()
+  : _bits(8),
+    _qmax(127),
+    _intervals(256),
+    _outputType(0),
+    _maxnodes(0),
+    _inscale(1),
+    _maxdev(0),
+    _rmsdev(0),
+    _area(0),
+    _refarea(0),
+    _ncompared(0)
+{}
+
+QuantizedNetwork::QuantizedNetwork(const CompiledNetwork& net,
+				   const float* rows, size_t n, size_t stride,
+				   int bits)
+  : _bits(bits == 16 ? 16 : 8),
+    _qmax(bits == 16 ? 32767 : 127),
+    _intervals(bits == 16 ? 4096 : 256),
+    _outputType(net.outputType()),
+    _maxnodes(0),
+    _inscale(1),
+    _maxdev(0),
+    _rmsdev(0),
+    _area(0),
+    _refarea(0),
+    _ncompared(0)
+{
+  if ( !net.good() ) return;
+
+  const vector<int>&   nodes  = net.nodes();
+  const vector<float>& weight = net.weights();
+  int nl = (int)nodes.size() - 1;
+  _mean  = net.mean();
+  _sigma = net.sigma();
+
+  // The sums are 32-bit: cap the integer range so that the products
+  // of the widest layer add up to at most ACCMAX. This leaves 16-bit
+  // networks about 13 bits for 20 inputs, 12 bits for 100.
+
+  int maxin = *max_element(nodes.begin(), nodes.end() - 1);
+  _qmax = min(_qmax, (int)sqrt((double)ACCMAX / max(maxin, 1)));
+
+  // Calibrate: largest absolute value of the inputs of each layer,
+  // from a float forward pass over the sample
+
+  vector<double> amax(nl, 0);
+  vector<double> y, x;
+  for (size_t p = 0; p < n; p++)
+    {
+      const float* row = rows + p * stride;
+      y.resize(nodes[0]);
+      for (int j = 0; j < nodes[0]; j++)
+	{
+	  y[j] = ((double)row[j] - _mean[j]) / _sigma[j];
+	  amax[0] = max(amax[0], fabs(y[j]));
+	}
+      int k = 0;
+      for (int l = 1; l < nl; l++)
+	{
+	  x.resize(nodes[l]);
+	  for (int i = 0; i < nodes[l]; i++)
+	    {
+	      double a = weight[k++];
+	      for (int j = 0; j < nodes[l-1]; j++) a += weight[k++] * y[j];
+	      x[i] = tanh(a);
+	      amax[l] = max(amax[l], fabs(x[i]));
+	    }
+	  swap(x, y);
+	}
+    }
+  if ( n == 0 )
+    {
+      amax[0] = 4;
+      for (int l = 1; l < nl; l++) amax[l] = 1;
+    }
+
+  vector<double> scale(nl);
+  for (int l = 0; l < nl; l++)
+    scale[l] = amax[l] > 0 ? amax[l] / _qmax : 1;
+  _inscale = (float)(1 / scale[0]);
+
+  // Quantize weights with one scale per layer, and the thresholds
+  // in units of the accumulator
+
+  double perunit = _intervals / (2 * ZMAX) * ONE;
+  int k = 0;
+  for (int l = 1; l <= nl; l++)
+    {
+      int nin  = nodes[l-1];
+      int nout = nodes[l];
+      double wmax = 0;
+      for (int i = 0; i < nout; i++)
+	for (int j = 0; j < nin; j++)
+	  wmax = max(wmax, fabs((double)weight[k + i * (nin + 1) + 1 + j]));
+      double wscale = wmax > 0 ? wmax / _qmax : 1;
+      double unit   = wscale * scale[l-1];
+
+      for (int i = 0; i < nout; i++)
+	{
+	  double t = weight[k++] / unit;
+	  t = max(-(double)ACCMAX, min((double)ACCMAX, t));
+	  _bias.push_back((int)lround(t));
+	  for (int j = 0; j < nin; j++)
+	    {
+	      int q = quantize((float)(weight[k++] / wscale), _qmax);
+	      if ( _bits == 8 )
+		_w8.push_back((signed char)q);
+	      else
+		_w16.push_back((short)q);
+	    }
+	}
+      _unit.push_back((float)unit);
+      _requant.push_back((float)(unit * perunit));
+
+      // Transfer function tables, at the ends of the intervals
+
+      for (int m = 0; m <= _intervals; m++)
+	{
+	  double z = -ZMAX + 2 * ZMAX * m / _intervals;
+	  if ( l < nl )
+	    _table.push_back(quantize((float)(tanh(z) / scale[l]), _qmax));
+	  else if ( _outputType == 0 )
+	    _outtable.push_back((float)(0.5 * (1 + tanh(z))));
+	}
+    }
+
+  _nodes    = nodes;
+  _maxnodes = *max_element(_nodes.begin(), _nodes.end());
+}
+
+template <class Q>
+const Q* QuantizedNetwork::_weights() const
+{
+  return 0;
+}
+
+template <>
+const signed char* QuantizedNetwork::_weights<signed char>() const
+{
+  return _w8.data();
+}
+
+template <>
+const short* QuantizedNetwork::_weights<short>() const
+{
+  return _w16.data();
+}
+
+// One pattern; x holds the normalized inputs. The loops run over the
+// inputs of each node.
+
+template <class Q>
+float QuantizedNetwork::_single(const float* x) const
+{
+  Q  stack[2*MAXSTACK];
+  vector<Q> heap;
+  Q* buf = stack;
+  if ( _maxnodes > MAXSTACK )
+    {
+      heap.resize(2*_maxnodes);
+      buf = &heap[0];
+    }
+  Q* y    = buf;
+  Q* next = buf + _maxnodes;
+
+  for (int j = 0; j < _nodes[0]; j++)
+    y[j] = (Q)quantize(x[j] * _inscale, _qmax);
+
+  const Q*   w = _weights<Q>();
+  const int* b = _bias.data();
+  const int* table = _table.data();
+  int nl = (int)_nodes.size() - 1;
+  for (int l = 1; l < nl; l++)
+    {
+      int   nin = _nodes[l-1];
+      float r   = _requant[l-1];
+      float off = (float)(_intervals / 2 * ONE);
+      for (int i = 0; i < _nodes[l]; i++)
+	{
+	  int a = b[i];
+	  for (int j = 0; j < nin; j++) a += (int)w[j] * (int)y[j];
+	  int u = position((float)a * r + off, _intervals);
+	  next[i] = (Q)interpolate(table, u);
+	  w += nin;
+	}
+      b += _nodes[l];
+      table += _intervals + 1;
+      swap(y, next);
+    }
+
+  // Output node
+
+  int a = b[0];
+  for (int j = 0; j < _nodes[nl-1]; j++) a += (int)w[j] * (int)y[j];
+  if ( _outputType == 1 ) return (float)a * _unit[nl-1];
+  int u = position((float)a * _requant[nl-1] + (float)(_intervals / 2 * ONE),
+		   _intervals);
+  return interpolate(_outtable.data(), u);
+}
+
+// Batch of patterns, in blocks of NNBLOCK stored node-major. The
+// sums of each layer are computed by the kernel for the instruction
+// set of the processor.
+
+template <class Q>
+void QuantizedNetwork::_batch(const float* rows, size_t n, size_t stride,
+			      float* out) const
+{
+  vector<Q>   buf(2 * _maxnodes * NNBLOCK, 0);
+  vector<int> acc(_maxnodes * NNBLOCK);
+  int nl = (int)_nodes.size() - 1;
+  float off = (float)(_intervals / 2 * ONE);
+
+  for (size_t first = 0; first < n; first += NNBLOCK)
+    {
+      int nb = (int)min((size_t)NNBLOCK, n - first);
+      Q* y    = &buf[0];
+      Q* next = &buf[_maxnodes * NNBLOCK];
+
+      for (int b = 0; b < nb; b++)
+	{
+	  const float* row = rows + (first + b) * stride;
+	  for (int j = 0; j < _nodes[0]; j++)
+	    {
+	      float x = (row[j] - _mean[j]) / _sigma[j];
+	      y[j * NNBLOCK + b] = (Q)quantize(x * _inscale, _qmax);
+	    }
+	}
+
+      const Q*   w = _weights<Q>();
+      const int* bias  = _bias.data();
+      const int* table = _table.data();
+      for (int l = 1; l <= nl; l++)
+	{
+	  int   nin = _nodes[l-1];
+	  float r   = _requant[l-1];
+	  qlayer(nin, _nodes[l], w, bias, y, &acc[0]);
+	  w += nin * _nodes[l];
+
+	  const int* a = &acc[0];
+	  if ( l < nl )
+	    for (int i = 0; i < _nodes[l]; i++)
+	      {
+		Q* xi = next + i * NNBLOCK;
+		const int* ai = a + i * NNBLOCK;
+		for (int b = 0; b < NNBLOCK; b++)
+		  xi[b] = (Q)interpolate(table,
+					 position((float)ai[b] * r + off,
+						  _intervals));
+	      }
+	  else if ( _outputType == 1 )
+	    for (int b = 0; b < nb; b++)
+	      out[first + b] = (float)a[b] * _unit[l-1];
+	  else
+	    for (int b = 0; b < nb; b++)
+	      out[first + b] =
+		interpolate(_outtable.data(),
+			    position((float)a[b] * r + off, _intervals));
+
+	  bias  += _nodes[l];
+	  table += _intervals + 1;
+	  swap(y, next);
+	}
+    }
+}
+
+template <class T>
+float QuantizedNetwork::_evaluate(const T* inp) const
+{
+  if ( !good() ) return 0;
+
+  float  stack[MAXSTACK];
+  vector<float> heap;
+  float* x = stack;
+  if ( _nodes[0] > MAXSTACK )
+    {
+      heap.resize(_nodes[0]);
+      x = &heap[0];
+    }
+  for (int j = 0; j < _nodes[0]; j++)
+    x[j] = (float)((inp[j] - _mean[j]) / _sigma[j]);
+
+  if ( _bits == 8 )
+    return _single<signed char>(x);
+  else
+    return _single<short>(x);
+}
+
+float QuantizedNetwork::evaluate(const float* inp) const
+{
+  return _evaluate(inp);
+}
+
+float QuantizedNetwork::evaluate(const double* inp) const
+{
+  return _evaluate(inp);
+}
+
+float QuantizedNetwork::evaluate(const vector<float>& inp) const
+{
+  return _evaluate(&inp[0]);
+}
+
+float QuantizedNetwork::evaluate(const vector<double>& inp) const
+{
+  return _evaluate(&inp[0]);
+}
+
+void QuantizedNetwork::evaluate(const float* rows, size_t n, size_t stride,
+				float* out) const
+{
+  if ( !good() ) return;
+  if ( _bits == 8 )
+    _batch<signed char>(rows, n, stride, out);
+  else
+    _batch<short>(rows, n, stride, out);
+}
+
+void QuantizedNetwork::compare(const CompiledNetwork& reference,
+			       const float* rows, size_t n, size_t stride,
+			       const float* target, const float* weight)
+{
+  vector<float> ref(n), out(n);
+  reference.evaluate(rows, n, stride, ref.data());
+  evaluate(rows, n, stride, out.data());
+
+  double maxdev = 0, sumsq = 0;
+  for (size_t p = 0; p < n; p++)
+    {
+      double d = fabs((double)out[p] - ref[p]);
+      maxdev = max(maxdev, d);
+      sumsq += d * d;
+    }
+  _ncompared = n;
+  _maxdev    = maxdev;
+  _rmsdev    = n > 0 ? sqrt(sumsq / n) : 0;
+  _refarea   = ROC(ref.data(), target, n, 0, weight).area();
+  _area      = ROC(out.data(), target, n, 0, weight).area();
+}
+
+void QuantizedNetwork::printReport() const
+{
+  cout << "QuantizedNetwork: " << _bits << "-bit (" << qkernels().isa 
+       << "), compared with the float "
+       << "network on " << _ncompared << " patterns" << endl
+       << "  largest deviation   " << _maxdev << endl
+       << "  RMS deviation       " << _rmsdev << endl
+       << "  area (float)        " << _refarea << endl
+       << "  area (quantized)    " << _area << endl
+       << "  loss of area        " << _refarea - _area << endl;
+}
+
+// Write out C++ function, with the same arithmetic as _single
+
+bool QuantizedNetwork::save(string filename) const
+{
+  if ( !good() ) return false;
+  ofstream out(filename.c_str());
+  if ( !out )
+    {
+      cout << "QuantizedNetwork::save - unable to open " << filename << endl;
+      return false;
+    }
+
+  time_t tt = time(0);
+  string ct(ctime(&tt)); ct = ct.substr(0,24);
+  string name = nameonly(filename);
+  string ns   = "jnq_" + name;
+  string qtype = _bits == 8 ? "signed char" : "short";
+  int nl = (int)_nodes.size() - 1;
+
+  out <<
+    "//-------------------------------------------"
+    "----------------------------\n";
+  out << "// Function: " << name << endl;
+  out << "//           " << _bits << "-bit quantized network" << endl;
+  out << "//           Layers:";
+  for (int l = 0; l <= nl; l++) out << " " << _nodes[l];
+  out << endl;
+  out << "// Created:  " << ct << endl;
+  out <<
+    "//----------------------------------------"
+    "-------------------------------\n";
+  out << "#include <cstddef>\n";
+  out << "#include <vector>\n";
+  out <<
+    "//-------------------------------------------"
+    "----------------------------\n";
+  out << "namespace " << ns << "\n";
+  out << "{\n";
+  out << scientific << setprecision(8);
+  out << "  const int   QMAX = " << _qmax << ";\n";
+  out << "  const int   INTERVALS = " << _intervals << ";\n";
+  out << "  const int   FRACTION  = " << FRACTION << ";\n";
+  out << "  const float INSCALE   = " << _inscale << "f;\n";
+  writearray(out, "float", "mean",  _mean.data(),  _mean.size(),  "f");
+  writearray(out, "float", "sigma", _sigma.data(), _sigma.size(), "f");
+
+  size_t kw = 0, kb = 0, kt = 0;
+  for (int l = 1; l <= nl; l++)
+    {
+      ostringstream w, b, t;
+      w << "w" << l;
+      b << "b" << l;
+      t << "t" << l;
+      size_t nw = (size_t)_nodes[l] * _nodes[l-1];
+      if ( _bits == 8 )
+	{
+	  vector<int> q(_w8.begin() + kw, _w8.begin() + kw + nw);
+	  writearray(out, qtype, w.str(), q.data(), nw);
+	}
+      else
+	writearray(out, qtype, w.str(), &_w16[kw], nw);
+      writearray(out, "int", b.str(), &_bias[kb], _nodes[l]);
+      out << "  const float r" << l << " = " << _requant[l-1] << "f;\n";
+      out << "  const float u" << l << " = " << _unit[l-1] << "f;\n";
+      if ( l < nl )
+	{
+	  writearray(out, "int", t.str(), &_table[kt], _intervals + 1);
+	  kt += _intervals + 1;
+	}
+      else if ( _outputType == 0 )
+	writearray(out, "float", "g", _outtable.data(), _outtable.size(),
+		   "f");
+      kw += nw;
+      kb += _nodes[l];
+    }
+
+  out << "\n";
+  out << "  inline int quantize(float t)\n";
+  out << "  {\n";
+  out << "    t = t < -QMAX ? -QMAX : (t > QMAX ? QMAX : t);\n";
+  out << "    return (int)(t + (t >= 0 ? 0.5f : -0.5f));\n";
+  out << "  }\n";
+  out << "\n";
+  out << "  inline int position(float u)\n";
+  out << "  {\n";
+  out << "    float top = (float)(INTERVALS * (1 << FRACTION) - 1);\n";
+  out << "    u = u < 0 ? 0 : (u > top ? top : u);\n";
+  out << "    return (int)u;\n";
+  out << "  }\n";
+  out << "\n";
+  out << "  inline int interpolate(const int* t, int u)\n";
+  out << "  {\n";
+  out << "    int k = u >> FRACTION;\n";
+  out << "    int f = u & ((1 << FRACTION) - 1);\n";
+  out << "    return t[k] + (((t[k+1] - t[k]) * f) >> FRACTION);\n";
+  out << "  }\n";
+  out << "\n";
+  out << "  inline float interpolate(const float* t, int u)\n";
+  out << "  {\n";
+  out << "    int k = u >> FRACTION;\n";
+  out << "    int f = u & ((1 << FRACTION) - 1);\n";
+  out << "    return t[k] + (t[k+1] - t[k]) * (f * (1.0f / (1 << FRACTION)));\n";
+  out << "  }\n";
+  out << "\n";
+  out << "  template <class T>\n";
+  out << "  inline float compute(const T* inp)\n";
+  out << "  {\n";
+  out << "    const float off = (float)(INTERVALS / 2 * (1 << FRACTION));\n";
+  for (int l = 0; l < nl; l++)
+    out << "    " << qtype << " y" << l << "[" << _nodes[l] << "];\n";
+  out << "    for (int j = 0; j < " << _nodes[0] << "; j++)\n";
+  out << "      y0[j] = (" << qtype << ")quantize((float)((inp[j] - mean[j]) "
+      << "/ sigma[j]) * INSCALE);\n";
+  for (int l = 1; l <= nl; l++)
+    {
+      int nin = _nodes[l-1];
+      out << "\n";
+      out << "    // Layer " << l << "\n";
+      if ( l < nl )
+	{
+	  out << "    for (int i = 0; i < " << _nodes[l] << "; i++)\n";
+	  out << "      {\n";
+	  out << "        int a = b" << l << "[i];\n";
+	  out << "        const " << qtype << "* w = w" << l << " + i * "
+	      << nin << ";\n";
+	  out << "        for (int j = 0; j < " << nin << "; j++) "
+	      << "a += (int)w[j] * (int)y" << l-1 << "[j];\n";
+	  out << "        y" << l << "[i] = (" << qtype << ")interpolate(t" << l
+	      << ", position((float)a * r" << l << " + off));\n";
+	  out << "      }\n";
+	}
+      else
+	{
+	  out << "    int a = b" << l << "[0];\n";
+	  out << "    for (int j = 0; j < " << nin << "; j++) "
+	      << "a += (int)w" << l << "[j] * (int)y" << l-1 << "[j];\n";
+	  if ( _outputType == 1 )
+	    out << "    return (float)a * u" << l << ";\n";
+	  else
+	    out << "    return interpolate(g, position((float)a * r" << l
+		<< " + off));\n";
+	}
+    }
+  out << "  }\n";
+  out << "}\n";
+  out << "\n";
+  out << "//-----------------------------------------------------------------------\n";
+  out << "float " << name << "(const float* inp)\n";
+  out << "{\n";
+  out << "  return " << ns << "::compute(inp);\n";
+  out << "}\n\n";
+  out << "//-----------------------------------------------------------------------\n";
+  out << "float " << name << "(const double* inp)\n";
+  out << "{\n";
+  out << "  return " << ns << "::compute(inp);\n";
+  out << "}\n\n";
+  out << "//-----------------------------------------------------------------------\n";
+  out << "float " << name << "(std::vector<double>& inp)\n";
+  out << "{\n";
+  out << "  return " << ns << "::compute(&inp[0]);\n";
+  out << "}\n\n";
+  out << "//-----------------------------------------------------------------------\n";
+  out << "// Compute outputs of n patterns, stored one after the other in in\n";
+  out << "void " << name << "_batch(const float* in, size_t n, float* out)\n";
+  out << "{\n";
+  out << "  for (size_t p = 0; p < n; p++)\n";
+  out << "    out[p] = " << ns << "::compute(in + p * " << _nodes[0] << ");\n";
+  out << "}\n";
+  return true;
+}
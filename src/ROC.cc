@@ -0,0 +1,189 @@
+//-----------------------------------------------------------------------------
+// File: ROC.cc
+// Purpose: Exact ROC curve, area and optimal cut from sorted outputs
+// Created: 18-Oct-2026
+//-----------------------------------------------------------------------------
+#include <algorithm>
+#include <cmath>
+
+#include "ThreadPool.h"
+#include "ROC.h"
+
+using namespace std;
+
+namespace {
+  struct Entry
+  {
+    float output;
+    float weight;
+    bool  signal;
+  };
+
+  // Decreasing order of output, with NaN (from a diverged network)
+  // after every number, so that the order stays a strict weak ordering
+
+  inline bool higher(const Entry& a, const Entry& b)
+  {
+    return a.output > b.output || 
+      (std::isnan(b.output) && !std::isnan(a.output));
+  }
+
+  // Minimum number of patterns sorted by one task
+  const size_t SORTCHUNK = 65536;
+
+  // Sort into decreasing order of output: sort chunks in parallel,
+  // then merge pairs of sorted runs, in parallel, until one is left
+
+  void sort(vector<Entry>& e, jtn::ThreadPool* pool)
+  {
+    size_t n = e.size();
+    int nchunk = pool ? pool->size() : 1;
+    if ( n < 2 * SORTCHUNK ) nchunk = 1;
+    if ( nchunk == 1 )
+      {
+	std::sort(e.begin(), e.end(), higher);
+	return;
+      }
+
+    size_t width = (n + nchunk - 1) / nchunk;
+    pool->run(nchunk, [&](int c, int thread)
+      {
+	size_t first = min(c * width, n);
+	size_t last  = min(first + width, n);
+	std::sort(e.begin() + first, e.begin() + last, higher);
+      });
+
+    for (; width < n; width *= 2)
+      {
+	int npair = (int)((n + 2 * width - 1) / (2 * width));
+	pool->run(npair, [&](int p, int thread)
+	  {
+	    size_t first  = p * 2 * width;
+	    size_t middle = min(first + width, n);
+	    size_t last   = min(first + 2 * width, n);
+	    inplace_merge(e.begin() + first, e.begin() + middle,
+			  e.begin() + last, higher);
+	  });
+      }
+  }
+
+  double significance(double s, double b)
+  {
+    return b > 0 ? s / sqrt(b) : -1;
+  }
+
+  double soversqrtsb(double s, double b)
+  {
+    return s + b > 0 ? s / sqrt(s + b) : -1;
+  }
+};
+
+ROC::ROC()
+  : _nsignal(0),
+    _nbackground(0),
+    _area(0),
+    _ninvalid(0)
+{}
+
+ROC::ROC(const float* output, const float* target, size_t n,
+	 jtn::ThreadPool* pool, const float* weight)
+  : _nsignal(0),
+    _nbackground(0),
+    _area(0),
+    _ninvalid(0)
+{
+  vector<Entry> e(n);
+  for (size_t i = 0; i < n; i++)
+    {
+      e[i].output = output[i];
+      e[i].weight = weight ? weight[i] : 1;
+      e[i].signal = target[i] > 0.5;
+    }
+  sort(e, pool);
+
+  // One point per distinct output. Each background pattern adds the
+  // signal above it, plus half of the signal with the same output.
+
+  double ns = 0, nb = 0, sum = 0;
+  size_t i = 0;
+  while ( i < n && !std::isnan(e[i].output) )
+    {
+      double ds = 0, db = 0;
+      size_t j = i;
+      for (; j < n && e[j].output == e[i].output; j++)
+	{
+	  if ( e[j].signal )
+	    ds += e[j].weight;
+	  else
+	    db += e[j].weight;
+	}
+      sum += db * (ns + 0.5 * ds);
+      ns  += ds;
+      nb  += db;
+      _cut.push_back(e[i].output);
+      _ns.push_back(ns);
+      _nb.push_back(nb);
+      i = j;
+    }
+
+  // Patterns with a NaN output pass no cut: they count as a single
+  // group below every other output
+
+  double ds = 0, db = 0;
+  _ninvalid = n - i;
+  for (; i < n; i++)
+    {
+      if ( e[i].signal )
+	ds += e[i].weight;
+      else
+	db += e[i].weight;
+    }
+  sum += db * (ns + 0.5 * ds);
+  ns  += ds;
+  nb  += db;
+
+  _nsignal     = ns;
+  _nbackground = nb;
+  _area = ns > 0 && nb > 0 ? sum / (ns * nb) : 0;
+}
+
+vector<float> ROC::signalEfficiency() const
+{
+  vector<float> eff(_ns.size(), 0);
+  if ( _nsignal > 0 )
+    for (size_t i = 0; i < _ns.size(); i++) eff[i] = _ns[i] / _nsignal;
+  return eff;
+}
+
+vector<float> ROC::backgroundEfficiency() const
+{
+  vector<float> eff(_nb.size(), 0);
+  if ( _nbackground > 0 )
+    for (size_t i = 0; i < _nb.size(); i++) eff[i] = _nb[i] / _nbackground;
+  return eff;
+}
+
+int ROC::best(FigureOfMerit fom, double sscale, double bscale) const
+{
+  if ( fom == kSIGNIFICANCE )
+    return best(significance, sscale, bscale);
+  else
+    return best(soversqrtsb, sscale, bscale);
+}
+
+int ROC::best(double (*fom)(double s, double b),
+	      double sscale, double bscale) const
+{
+  int    ibest = -1;
+  double vbest = 0;
+  for (int i = 0; i < size(); i++)
+    {
+      double v = fom(sscale * _ns[i], bscale * _nb[i]);
+      if ( ibest < 0 || v > vbest )
+	{
+	  ibest = i;
+	  vbest = v;
+	}
+    }
+  return ibest;
+}
@@ -0,0 +1,303 @@
+//-----------------------------------------------------------------------------
+// File: Sweep.cc
+// Purpose: Parallel hyperparameter sweep with successive halving
+// Created: 18-Oct-2026
+//-----------------------------------------------------------------------------
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <algorithm>
+#include <random>
+#include <cmath>
+
+#include "ThreadPool.h"
+#include "Sweep.h"
+
+using namespace std;
+
+namespace {
+  // Order by RMS, with failed (NaN) networks last
+  inline bool lower(float a, float b)
+  {
+    if ( std::isnan(b) ) return !std::isnan(a);
+    return a < b;
+  }
+};
+
+Sweep::Sweep(Jetnet& data)
+  : _data(data),
+    _nrandom(0),
+    _seed(1),
+    _first(10),
+    _total(100),
+    _reduction(3),
+    _workers(0)
+{}
+
+Sweep::~Sweep()
+{
+  _clear();
+}
+
+void Sweep::add(string name, const vector<float>& values)
+{
+  Range r;
+  r.name   = name;
+  r.values = values;
+  r.low    = r.high = 0;
+  r.logscale = false;
+  _ranges.push_back(r);
+}
+
+void Sweep::add(string name, float low, float high, bool logscale)
+{
+  Range r;
+  r.name   = name;
+  r.low    = low;
+  r.high   = high;
+  r.logscale = logscale;
+  _ranges.push_back(r);
+}
+
+void Sweep::setRandom(int n, int seed)
+{
+  _nrandom = max(n, 0);
+  _seed    = seed;
+}
+
+void Sweep::setEpochs(int first, int total, int reduction)
+{
+  _first     = max(first, 1);
+  _total     = max(total, _first);
+  _reduction = max(reduction, 2);
+}
+
+void Sweep::setWorkers(int n)
+{
+  _workers = n;
+}
+
+bool Sweep::run()
+{
+  _clear();
+  if ( ! _configure() ) return false;
+
+  if ( _data.patterns(Jetnet::kTESTING).size() == 0 )
+    {
+      cout << "Sweep::run - no testing patterns" << endl;
+      return false;
+    }
+
+  int nthreads = _workers > 0 ? _workers : thread::hardware_concurrency();
+  jtn::ThreadPool pool(nthreads);
+
+  vector<int> alive(_results.size());
+  for (int i = 0; i < (int)alive.size(); i++) alive[i] = i;
+
+  int epochs = _first;
+  for (int round = 1;; round++)
+    {
+      cout << "Sweep: round " << round << ", " << alive.size()
+	   << " networks, " << epochs << " epochs" << endl;
+
+      pool.run(alive.size(), [&](int i, int thread)
+	{
+	  _train(_results[alive[i]], epochs);
+	});
+
+      stable_sort(alive.begin(), alive.end(), [&](int a, int b)
+	{
+	  return lower(_results[a].rms, _results[b].rms);
+	});
+
+      if ( epochs >= _total || alive.size() <= 1 ) break;
+
+      // Stop all but the best 1/reduction networks
+
+      int keep = ((int)alive.size() + _reduction - 1) / _reduction;
+      for (int i = keep; i < (int)alive.size(); i++)
+	{
+	  delete _results[alive[i]].network;
+	  _results[alive[i]].network = 0;
+	}
+      alive.resize(keep);
+      epochs = min(epochs * _reduction, _total);
+    }
+
+  // Rank by number of epochs survived, then by RMS
+
+  stable_sort(_results.begin(), _results.end(),
+	      [](const Result& a, const Result& b)
+	{
+	  if ( a.epochs != b.epochs ) return a.epochs > b.epochs;
+	  return lower(a.rms, b.rms);
+	});
+  return true;
+}
+
+float Sweep::rms(int rank)
+{
+  if ( rank < 0 || rank >= size() ) return -99.0;
+  return _results[rank].rms;
+}
+
+int Sweep::epochs(int rank)
+{
+  if ( rank < 0 || rank >= size() ) return 0;
+  return _results[rank].epochs;
+}
+
+float Sweep::value(int rank, string name)
+{
+  if ( rank < 0 || rank >= size() ) return -99.0;
+  for (int k = 0; k < (int)_ranges.size(); k++)
+    if ( _ranges[k].name == name ) return _results[rank].values[k];
+  return -99.0;
+}
+
+Jetnet* Sweep::network(int rank)
+{
+  if ( rank < 0 || rank >= size() ) return 0;
+  return _results[rank].network;
+}
+
+bool Sweep::write(string filename)
+{
+  ofstream out(filename.c_str());
+  if ( !out )
+    {
+      cout << "Sweep::write - unable to open " << filename << endl;
+      return false;
+    }
+
+  out << "#" << setw(5) << "rank" << setw(8) << "epochs" << setw(12) << "rms";
+  for (int k = 0; k < (int)_ranges.size(); k++)
+    out << " " << setw(max(12, (int)_ranges[k].name.size()))
+	<< _ranges[k].name;
+  out << endl;
+
+  for (int i = 0; i < size(); i++)
+    {
+      const Result& r = _results[i];
+      out << setw(6) << i << setw(8) << r.epochs
+	  << setw(12) << setprecision(6) << r.rms;
+      for (int k = 0; k < (int)_ranges.size(); k++)
+	out << " " << setw(max(12, (int)_ranges[k].name.size()))
+	    << setprecision(6) << r.values[k];
+      out << endl;
+    }
+  return true;
+}
+
+// Internal methods
+///////////////////
+
+// Make the parameter sets, from the grid or at random
+
+bool Sweep::_configure()
+{
+  int nranges = (int)_ranges.size();
+  for (int k = 0; k < nranges; k++)
+    if ( _ranges[k].values.size() == 0 && _nrandom == 0 )
+      {
+	cout << "Sweep::run - range of " << _ranges[k].name
+	     << " requires random search (setRandom)" << endl;
+	return false;
+      }
+
+  vector<vector<float> > sets;
+  if ( _nrandom > 0 )
+    {
+      mt19937 engine(_seed);
+      uniform_real_distribution<double> uniform(0, 1);
+      for (int n = 0; n < _nrandom; n++)
+	{
+	  vector<float> values(nranges);
+	  for (int k = 0; k < nranges; k++)
+	    {
+	      const Range& r = _ranges[k];
+	      double u = uniform(engine);
+	      if ( r.values.size() > 0 )
+		values[k] = r.values[min((size_t)(u * r.values.size()),
+					 r.values.size() - 1)];
+	      else if ( r.logscale && r.low > 0 && r.high > 0 )
+		values[k] = r.low * pow(r.high / r.low, u);
+	      else
+		values[k] = r.low + (r.high - r.low) * u;
+	    }
+	  sets.push_back(values);
+	}
+    }
+  else
+    {
+      // Every combination; the last parameter varies fastest
+
+      size_t ngrid = 1;
+      for (int k = 0; k < nranges; k++) ngrid *= _ranges[k].values.size();
+      for (size_t n = 0; n < ngrid; n++)
+	{
+	  vector<float> values(nranges);
+	  size_t index = n;
+	  for (int k = nranges - 1; k >= 0; k--)
+	    {
+	      size_t m = _ranges[k].values.size();
+	      values[k] = _ranges[k].values[index % m];
+	      index /= m;
+	    }
+	  sets.push_back(values);
+	}
+    }
+
+  for (size_t n = 0; n < sets.size(); n++)
+    {
+      Result r;
+      r.values  = sets[n];
+      r.epochs  = 0;
+      r.rms     = 0;
+      r.network = 0;
+      for (int k = 0; k < nranges; k++)
+	if ( _ranges[k].name == "hidden" )
+	  r.values[k] = max(1.0f, floor(r.values[k] + 0.5f));
+      _results.push_back(r);
+    }
+  return _results.size() > 0;
+}
+
+// Create network on first use, then continue its training up to the
+// given number of epochs
+
+void Sweep::_train(Result& r, int epochs)
+{
+  if ( r.network == 0 )
+    {
+      vstring vars   = _data.names();
+      int     hidden = _data.nodes()[1];
+      for (int k = 0; k < (int)_ranges.size(); k++)
+	if ( _ranges[k].name == "hidden" ) hidden = (int)r.values[k];
+
+      Jetnet::Output output = _data.parameter("outputType") == 4
+	? Jetnet::kLINEAR
+	: Jetnet::kSIGMOID;
+
+      Jetnet* nn = new Jetnet(vars, hidden, output);
+      nn->sharePatterns(Jetnet::kTRAINING, _data.patterns(Jetnet::kTRAINING));
+      nn->sharePatterns(Jetnet::kTESTING,  _data.patterns(Jetnet::kTESTING));
+      for (int k = 0; k < (int)_ranges.size(); k++)
+	if ( _ranges[k].name != "hidden" )
+	  nn->setParameter(_ranges[k].name, r.values[k]);
+
+      // One thread per network; the networks run in parallel
+      nn->setThreads(1);
+      nn->begin();
+      r.network = nn;
+    }
+
+  for (; r.epochs < epochs; r.epochs++) r.network->train();
+  r.rms = r.network->test(Jetnet::kTESTING);
+}
+
+void Sweep::_clear()
+{
+  for (size_t i = 0; i < _results.size(); i++) delete _results[i].network;
+  _results.clear();
+}
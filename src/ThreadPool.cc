@@ -0,0 +1,90 @@
+//-----------------------------------------------------------------------------
+// File: ThreadPool.cc
+// Purpose: Fixed-size pool of worker threads
+// Created: 18-Oct-2026
+//-----------------------------------------------------------------------------
+#include "ThreadPool.h"
+
+using namespace std;
+using namespace jtn;
+
+ThreadPool::ThreadPool(int nthreads)
+  : _nthreads(nthreads < 1 ? 1 : nthreads),
+    _task(0),
+    _ntasks(0),
+    _next(0),
+    _busy(0),
+    _generation(0),
+    _stop(false)
+{
+  // The calling thread acts as thread 0
+  for (int t = 1; t < _nthreads; t++)
+    _workers.push_back(thread(&ThreadPool::_work, this, t));
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    lock_guard<mutex> lock(_mutex);
+    _stop = true;
+  }
+  _start.notify_all();
+  for (int t = 0; t < (int)_workers.size(); t++) _workers[t].join();
+}
+
+void ThreadPool::run(int ntasks, const function<void(int, int)>& task)
+{
+  if ( ntasks <= 0 ) return;
+
+  // Avoid waking up the workers for a single task
+
+  if ( ntasks == 1 || _nthreads == 1 )
+    {
+      for (int i = 0; i < ntasks; i++) task(i, 0);
+      return;
+    }
+
+  {
+    lock_guard<mutex> lock(_mutex);
+    _task   = &task;
+    _ntasks = ntasks;
+    _next   = 0;
+    _busy   = (int)_workers.size();
+    _generation++;
+  }
+  _start.notify_all();
+
+  _drain(0);
+
+  unique_lock<mutex> lock(_mutex);
+  _done.wait(lock, [this]{ return _busy == 0; });
+  _task = 0;
+}
+
+void ThreadPool::_drain(int thread)
+{
+  int i;
+  while ( (i = _next++) < _ntasks ) (*_task)(i, thread);
+}
+
+void ThreadPool::_work(int thread)
+{
+  long generation = 0;
+  while ( true )
+    {
+      {
+	unique_lock<mutex> lock(_mutex);
+	_start.wait(lock, [&]{ return _stop || _generation != generation; });
+	if ( _stop ) return;
+	generation = _generation;
+      }
+
+      _drain(thread);
+
+      {
+	lock_guard<mutex> lock(_mutex);
+	_busy--;
+      }
+      _done.notify_one();
+    }
+}
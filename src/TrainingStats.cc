@@ -0,0 +1,91 @@
+//-----------------------------------------------------------------------------
+// File: TrainingStats.cc
+// Purpose: Counters and timers of the training loop
+// Created: 18-Oct-2026
+//-----------------------------------------------------------------------------
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+
+#include "TrainingStats.h"
+
+using namespace std;
+
+namespace {
+  const char* PHASE[TrainingStats::kNPHASES] =
+    {"forward", "backward", "update", "jetnet", "test"};
+};
+
+void TrainingStats::reset()
+{
+  _epochs   = 0;
+  _patterns = 0;
+  _seconds  = 0;
+  for (int i = 0; i < kNPHASES; i++) _time[i] = 0;
+  _updates    = 0;
+  _iterations = 0;
+  _searches   = 0;
+  _longest    = 0;
+  _restarts   = 0;
+  _warnings   = 0;
+  _lastWarning= 0;
+}
+
+// Counts and times add up; restarts and the latest warning are
+// states, taken from other
+
+void TrainingStats::add(const TrainingStats& other)
+{
+  _epochs   += other._epochs;
+  _patterns += other._patterns;
+  _seconds  += other._seconds;
+  for (int i = 0; i < kNPHASES; i++) _time[i] += other._time[i];
+  _updates    += other._updates;
+  _iterations += other._iterations;
+  _searches   += other._searches;
+  if ( other._longest > _longest ) _longest = other._longest;
+  _restarts  = other._restarts;
+  _warnings += other._warnings;
+  if ( other._lastWarning != 0 ) _lastWarning = other._lastWarning;
+}
+
+string TrainingStats::json(int epoch, float error) const
+{
+  ostringstream os;
+  os << setprecision(6) << "{";
+  if ( epoch >= 0 ) os << "\"epoch\": " << epoch << ", ";
+  if ( error >= 0 ) os << "\"error\": " << error << ", ";
+  os << "\"patterns\": "  << _patterns
+     << ", \"seconds\": " << _seconds
+     << ", \"patterns_per_second\": " << patternsPerSecond();
+  for (int i = 0; i < kNPHASES; i++)
+    os << ", \"" << PHASE[i] << "\": " << _time[i];
+  os << ", \"updates\": "    << _updates
+     << ", \"line_search_iterations\": " << _iterations
+     << ", \"line_searches\": "          << _searches
+     << ", \"longest_line_search\": "    << _longest
+     << ", \"restarts\": "    << _restarts
+     << ", \"warnings\": "    << _warnings
+     << ", \"last_warning\": "<< _lastWarning
+     << "}";
+  return os.str();
+}
+
+void TrainingStats::print() const
+{
+  cout << "Training statistics" << endl
+       << "  epochs               " << _epochs << endl
+       << "  patterns             " << _patterns << endl
+       << "  seconds              " << _seconds << endl
+       << "  patterns/second      " << patternsPerSecond() << endl;
+  for (int i = 0; i < kNPHASES; i++)
+    cout << "  " << setw(21) << left << PHASE[i] << right
+	 << _time[i] << " s" << endl;
+  cout << "  updates              " << _updates << endl
+       << "  line-search steps    " << _iterations << endl
+       << "  line searches        " << _searches << endl
+       << "  longest line search  " << _longest << endl
+       << "  restarts             " << _restarts << endl
+       << "  warnings             " << _warnings << endl
+       << "  last warning         " << _lastWarning << endl;
+}
@@ -0,0 +1,287 @@
+//-----------------------------------------------------------------------------
+// File: WeightFile.cc
+// Purpose: Memory-mapped binary network weight files
+// Created: 18-Oct-2026
+//-----------------------------------------------------------------------------
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fstream>
+#include <iomanip>
+
+#include "network.h"
+#include "WeightFile.h"
+
+using namespace std;
+
+namespace {
+  const char   MAGIC[8] = {'J','N','W','G','T','S',0,0};
+  const uint32_t VERSION = 1;
+  const size_t ALIGN = 64;
+
+  size_t align(size_t n) { return ((n + ALIGN - 1) / ALIGN) * ALIGN; }
+
+  struct Header
+  {
+    char     magic[8];
+    uint32_t version;
+    uint32_t outputType;
+    uint32_t nlayers;
+    uint32_t ninputs;
+    uint64_t nweights;
+    uint64_t offset;
+    uint64_t checksum;
+  };
+
+  // 64-bit FNV-1a hash
+  uint64_t checksum(const char* p, size_t n)
+  {
+    uint64_t h = 14695981039346656037ULL;
+    for (size_t i = 0; i < n; i++)
+      {
+	h ^= (unsigned char)p[i];
+	h *= 1099511628211ULL;
+      }
+    return h;
+  }
+
+  size_t nparameters(const vector<int>& nodes)
+  {
+    size_t n = 0;
+    for (size_t l = 1; l < nodes.size(); l++)
+      n += (size_t)nodes[l] * (nodes[l-1] + 1);
+    return n;
+  }
+
+  // True if the sizes of the header fit in a file of length bytes.
+  // Each bound is checked by a division, so that no product or sum of
+  // the (untrusted) fields can overflow.
+  bool valid(const Header& h, size_t length)
+  {
+    if ( h.offset < sizeof(Header) || h.offset > length ) return false;
+    if ( h.nweights > (length - h.offset) / sizeof(double) ||
+	 h.nweights * sizeof(double) != length - h.offset ) return false;
+    if ( h.nlayers < 2 ||
+	 h.nlayers > (h.offset - sizeof(Header)) / sizeof(int32_t) )
+      return false;
+    return true;
+  }
+
+  // True if every layer has nodes, there are ninputs inputs and the
+  // layers have nweights weights in all
+  bool valid(const vector<int>& nodes, const Header& h)
+  {
+    if ( nodes[0] <= 0 || (uint32_t)nodes[0] != h.ninputs ) return false;
+    size_t n = 0;
+    for (size_t l = 1; l < nodes.size(); l++)
+      {
+	if ( nodes[l] <= 0 ) return false;
+	size_t k = (size_t)nodes[l] * ((size_t)nodes[l-1] + 1);
+	if ( k > h.nweights - n ) return false;
+	n += k;
+      }
+    return n == h.nweights;
+  }
+};
+
+WeightFile::WeightFile(string filename)
+  : _outputType(0),
+    _nweights(0),
+    _offset(0),
+    _length(0),
+    _base(0)
+{
+  int fd = open(filename.c_str(), O_RDONLY);
+  if ( fd < 0 ) return;
+
+  struct stat st;
+  if ( fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(Header) )
+    {
+      close(fd);
+      return;
+    }
+  _length = st.st_size;
+
+  void* base = mmap(0, _length, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if ( base == MAP_FAILED ) return;
+
+  // Check header and checksum
+
+  Header h;
+  memcpy(&h, base, sizeof(Header));
+  const char* p = (const char*)base + sizeof(Header);
+  if ( memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+       h.version != VERSION || !valid(h, _length) ||
+       h.checksum != checksum(p, _length - sizeof(Header)) )
+    {
+      munmap(base, _length);
+      return;
+    }
+
+  // Nodes, means and scales
+
+  const char* end = (const char*)base + h.offset;
+  _nodes.resize(h.nlayers);
+  memcpy(&_nodes[0], p, h.nlayers * sizeof(int32_t));
+  p += h.nlayers * sizeof(int32_t);
+
+  bool ok = valid(_nodes, h) &&
+    2 * (size_t)h.ninputs * sizeof(float) <= (size_t)(end - p);
+  if ( ok )
+    {
+      _mean.resize(h.ninputs);
+      _sigma.resize(h.ninputs);
+      memcpy(&_mean[0],  p, h.ninputs * sizeof(float));
+      p += h.ninputs * sizeof(float);
+      memcpy(&_sigma[0], p, h.ninputs * sizeof(float));
+      p += h.ninputs * sizeof(float);
+
+      // Names
+
+      for (uint32_t i = 0; i < h.ninputs; i++)
+	{
+	  uint32_t len;
+	  if ( sizeof(len) > (size_t)(end - p) ) break;
+	  memcpy(&len, p, sizeof(len));
+	  p += sizeof(len);
+	  if ( len > (size_t)(end - p) ) break;
+	  _names.push_back(string(p, len));
+	  p += len;
+	}
+      ok = _names.size() == h.ninputs;
+    }
+  if ( !ok )
+    {
+      _nodes.clear();
+      _mean.clear();
+      _sigma.clear();
+      _names.clear();
+      munmap(base, _length);
+      return;
+    }
+
+  _outputType = h.outputType;
+  _nweights   = h.nweights;
+  _offset     = h.offset;
+  _base       = (char*)base;
+}
+
+WeightFile::~WeightFile()
+{
+  if ( _base ) munmap(_base, _length);
+}
+
+const double* WeightFile::weights() const
+{
+  if ( _base == 0 ) return 0;
+  return (const double*)(_base + _offset);
+}
+
+int WeightFile::write(string binaryfile,
+		      const vector<int>&    nodes,
+		      const vector<double>& weight,
+		      const vector<string>& var,
+		      const vector<float>&  mean,
+		      const vector<float>&  sigma,
+		      int outputType)
+{
+  if ( nodes.size() < 2 ||
+       nparameters(nodes) != weight.size() ||
+       var.size()   != (size_t)nodes[0] ||
+       mean.size()  != var.size() ||
+       sigma.size() != var.size() ) return -2;
+
+  // Assemble everything after the header, so that it can be checksummed
+
+  size_t ninputs  = var.size();
+  size_t namesize = 0;
+  for (size_t i = 0; i < ninputs; i++)
+    namesize += sizeof(uint32_t) + var[i].size();
+
+  size_t offset = align(sizeof(Header) + nodes.size() * sizeof(int32_t) +
+			2 * ninputs * sizeof(float) + namesize);
+  vector<char> buf(offset - sizeof(Header) + weight.size() * sizeof(double), 0);
+
+  char* p = &buf[0];
+  for (size_t l = 0; l < nodes.size(); l++)
+    {
+      int32_t n = nodes[l];
+      memcpy(p, &n, sizeof(n));
+      p += sizeof(n);
+    }
+  memcpy(p, &mean[0],  ninputs * sizeof(float)); p += ninputs * sizeof(float);
+  memcpy(p, &sigma[0], ninputs * sizeof(float)); p += ninputs * sizeof(float);
+  for (size_t i = 0; i < ninputs; i++)
+    {
+      uint32_t len = var[i].size();
+      memcpy(p, &len, sizeof(len));
+      p += sizeof(len);
+      memcpy(p, var[i].data(), len);
+      p += len;
+    }
+  memcpy(&buf[offset - sizeof(Header)], &weight[0],
+	 weight.size() * sizeof(double));
+
+  Header h;
+  memcpy(h.magic, MAGIC, sizeof(MAGIC));
+  h.version    = VERSION;
+  h.outputType = outputType;
+  h.nlayers    = nodes.size();
+  h.ninputs    = ninputs;
+  h.nweights   = weight.size();
+  h.offset     = offset;
+  h.checksum   = checksum(&buf[0], buf.size());
+
+  ofstream out(binaryfile.c_str(), ios::binary);
+  if ( !out ) return -1;
+  out.write((const char*)&h, sizeof(Header));
+  out.write(&buf[0], buf.size());
+  out.close();
+  return out.fail() ? -1 : 0;
+}
+
+int WeightFile::convert(string netfile, string binaryfile)
+{
+  vector<int>    nodes;
+  vector<double> weight;
+  vector<string> var;
+  vector<float>  mean;
+  vector<float>  sigma;
+  int outputType = 0;
+  if ( nnload(netfile, nodes, weight, var, mean, sigma, outputType) != 0 )
+    return -1;
+  return write(binaryfile, nodes, weight, var, mean, sigma, outputType);
+}
+
+int WeightFile::dump(string binaryfile, string netfile)
+{
+  WeightFile wf(binaryfile);
+  if ( !wf.good() ) return -1;
+
+  ofstream out(netfile.c_str());
+  if ( !out ) return -1;
+
+  // Same layout as jnDumpWeightsMLP and jnWriteName
+
+  out << " JETNET V3.4 weights ";
+  for (size_t l = 0; l < wf._nodes.size(); l++)
+    out << setw(5) << wf._nodes[l];
+  out << "\n" << setw(12) << wf._nweights << "\n";
+
+  out << setprecision(17);
+  const double* w = wf.weights();
+  for (size_t i = 0; i < wf._nweights; i++)
+    out << "  " << w[i] << "\n";
+  out << "Inputs\n";
+
+  out << setprecision(9);
+  for (size_t i = 0; i < wf._names.size(); i++)
+    out << wf._names[i] << " " << wf._mean[i] << " " << wf._sigma[i] << "\n";
+  out << (wf._outputType == 0 ? "Sigmoid Output" : "Linear Output") << "\n";
+  out.close();
+  return out.fail() ? -1 : 0;
+}
@@ -14,23 +14,22 @@
 #include <iomanip>
 #include <sstream>
 
+#include "nnkernel.h"
+#include "ActivationTable.h"
+
 using namespace std;
 
 // Extract name of a file without extension
-namespace {
-  string nameonly(string filename)
-  {
-    int i = filename.rfind("/");
-    int j = filename.rfind(".");
-    if ( j < 0 ) j = filename.size();
-    return filename.substr(i+1,j-i-1);
-  }
+string nameonly(string filename)
+{
+  int i = filename.rfind("/");
+  int j = filename.rfind(".");
+  if ( j < 0 ) j = filename.size();
+  return filename.substr(i+1,j-i-1);
 }
 
-extern double sigmoid(double x);
-extern double sigmoidout(double x);
-
-// Routine to calculate network outputs recursively
+// Routine to calculate network outputs recursively. The transfer 
+// functions are applied to each layer by the vectorized kernels.
 
 void nnfeed(int l, int k, 
 	    vector<int>&    nodes, 
@@ -53,17 +52,15 @@ void nnfeed(int l, int k,
 	  x = x + weight[k]*inp[j]; 
 	  k++;
 	}
-      float y;
-      if ( !last )
-	y = sigmoid(x);
-      else if ( outputType == 0 )
-	y = sigmoidout(x);
-      else
-	y = x;
-      inn[i]  = y;
-      out.push_back(y);
+      inn[i] = x;
     }
 
+  if ( !last )
+    nnactivate(2, &inn[0], nodes[l]);
+  else if ( outputType == 0 )
+    nnactivate(1, &inn[0], nodes[l]);
+  out = inn;
+
   if ( last )
     return;
   else
@@ -205,6 +202,15 @@ int nnload(string filename,
 	  sigma.push_back(y);
 	}
     }
+
+  // Type of output node follows the inputs
+  if ( getline(stream, line,'\n') )
+    {
+      if ( line == "Sigmoid Output" )
+	outputType = 0;
+      else if ( line == "Linear Output" )
+	outputType = 1;
+    }
   return 0;
 }
 
@@ -221,6 +227,223 @@ int nncompute(vector<int>&    nodes,
   return 0;
 }
 
+// Write weights of one array, several values per line
+
+namespace {
+  void nnwritearray(ostream& out, string decl, vector<double>& values)
+  {
+    out << "    alignas(64) static constexpr T " << decl 
+	<< "[" << values.size() << "] = \n      {";
+    out << setprecision(9);
+    for (int i = 0; i < (int)values.size(); i++)
+      {
+	if ( i > 0 ) out << ",";
+	if ( i > 0 && i % 4 == 0 ) out << "\n       ";
+	out << setw(17) << values[i];
+      }
+    out << "};\n";
+  }
+}
+
+// Write network function as arrays of weights and loops over nodes.
+// The weights of each layer are stored input-major, so that the loops
+// over the nodes of a layer vectorize. The function is a template
+// that is instantiated for double and float.
+
+void nnwritearrays(ostream& out,
+		   string name,
+		   string sigmoid,
+		   string sigmoidout,
+		   vector<int>&    nodes, 
+		   vector<double>& weight, 
+		   vector<float>&  mean,
+		   vector<float>&  sigma,
+		   int outputType)
+{
+  int nlayer = nodes.size();
+  string ns  = "jn" + name + "_detail";
+
+  out << "namespace " << ns << "\n";
+  out << "{\n";
+  out << "  using std::tanh;\n";
+  out << "  using std::exp;\n";
+  out << "\n";
+  out << "  template <class T>\n";
+  out << "  inline T sigmoid(T x) { return " << sigmoid << "; }\n";
+  out << "\n";
+  out << "  template <class T>\n";
+  out << "  inline T sigmoidout(T x) { return " << sigmoidout << "; }\n";
+  out << "\n";
+
+  // Arrays
+
+  out << "  // Layer l: thresholds t<l>, and weights w<l>, where\n";
+  out << "  // w<l>[j*nodes[l]+i] connects node j of layer l-1 to node i\n";
+  out << "  template <class T>\n";
+  out << "  struct weights\n";
+  out << "  {\n";
+
+  vector<double> m(mean.begin(), mean.end());
+  vector<double> s(sigma.begin(), sigma.end());
+  nnwritearray(out, "mean",  m);
+  nnwritearray(out, "sigma", s);
+
+  int k = 0;
+  for (int l = 1; l < nlayer; l++)
+    {
+      int nin  = nodes[l-1];
+      int nout = nodes[l];
+      vector<double> t(nout), w(nin * nout);
+      for (int i = 0; i < nout; i++)
+	{
+	  t[i] = weight[k++];
+	  for (int j = 0; j < nin; j++) w[j * nout + i] = weight[k++];
+	}
+      ostringstream tl, wl;
+      tl << "t" << l;
+      wl << "w" << l;
+      nnwritearray(out, tl.str(), t);
+      nnwritearray(out, wl.str(), w);
+    }
+  out << "  };\n";
+
+  out << "  template <class T> constexpr T weights<T>::mean[];\n";
+  out << "  template <class T> constexpr T weights<T>::sigma[];\n";
+  for (int l = 1; l < nlayer; l++)
+    {
+      out << "  template <class T> constexpr T weights<T>::t" << l << "[];\n";
+      out << "  template <class T> constexpr T weights<T>::w" << l << "[];\n";
+    }
+  out << "\n";
+
+  // Loops
+
+  out << "  template <class T>\n";
+  out << "  inline void compute(const T* in, T* out)\n";
+  out << "  {\n";
+  out << "    typedef weights<T> W;\n";
+  for (int l = 0; l < nlayer; l++)
+    out << "    alignas(64) T x" << l << "[" << nodes[l] << "];\n";
+  out << "\n";
+  out << "    for (int j = 0; j < " << nodes[0] << "; j++)\n";
+  out << "      x0[j] = (in[j] - W::mean[j]) / W::sigma[j];\n";
+
+  for (int l = 1; l < nlayer; l++)
+    {
+      int nin  = nodes[l-1];
+      int nout = nodes[l];
+      out << "\n";
+      out << "    // Layer " << l << "\n";
+      out << "    for (int i = 0; i < " << nout << "; i++) x" << l 
+	  << "[i] = W::t" << l << "[i];\n";
+      out << "    for (int j = 0; j < " << nin << "; j++)\n";
+      out << "      {\n";
+      out << "        const T  y = x" << l-1 << "[j];\n";
+      out << "        const T* w = W::w" << l << " + j * " << nout << ";\n";
+      out << "        for (int i = 0; i < " << nout << "; i++) x" << l 
+	  << "[i] += w[i] * y;\n";
+      out << "      }\n";
+
+      string sigtype;
+      if ( l < nlayer-1 )
+	sigtype = "sigmoid";
+      else if ( outputType == 0 )
+	sigtype = "sigmoidout";
+      if ( sigtype != "" )
+	out << "    for (int i = 0; i < " << nout << "; i++) x" << l
+	    << "[i] = " << sigtype << "(x" << l << "[i]);\n";
+    }
+  out << "\n";
+  out << "    for (int i = 0; i < " << nodes[nlayer-1] << "; i++) out[i] = x" 
+      << nlayer-1 << "[i];\n";
+  out << "  }\n";
+  out << "}\n";
+  out << "\n";
+
+  // Entry points
+
+  int ninput  = nodes[0];
+  int noutput = nodes[nlayer-1];
+  out << "void jn" << name << "(double* in, double* out)\n";
+  out << "{\n";
+  out << "  " << ns << "::compute<double>(in, out);\n";
+  out << "}\n\n";
+
+  string types[2] = {"double", "float"};
+  for (int i = 0; i < 2; i++)
+    {
+      out << "//-----------------------------------------------------------------------\n";
+      out << "// Compute outputs of n patterns, stored one after the other in in\n";
+      out << "void jn" << name << "_batch(const " << types[i] 
+	  << "* in, size_t n, " << types[i] << "* out)\n";
+      out << "{\n";
+      out << "  for (size_t p = 0; p < n; p++)\n";
+      out << "    " << ns << "::compute<" << types[i] << ">(in + p * " 
+	  << ninput << ", out + p * " << noutput << ");\n";
+      out << "}\n\n";
+    }
+}
+
+// Write the shared table of tanh and the functions that interpolate in
+// it. The table is a static member of a class template, so that the
+// linker keeps a single copy for all the functions of a program that
+// use the same table.
+
+void nnwritetable(ostream& out, const ActivationTable* table)
+{
+  int n = table->intervals();
+  const float* value = table->values();
+  ostringstream s; s << n;
+  string tn = "jntable" + s.str();
+
+  out << "#ifndef JNTABLE" << n << "\n";
+  out << "#define JNTABLE" << n << "\n";
+  out << "// Table of tanh on [-" << ActivationTable::RANGE << ", " 
+      << ActivationTable::RANGE << "], " << n 
+      << " intervals, largest error " << table->maxError() << "\n";
+  out << "template <class Dummy>\n";
+  out << "struct " << tn << "\n";
+  out << "{\n";
+  out << "  alignas(64) static const float value[" << n+1 << "];\n";
+  out << "};\n";
+  out << "template <class Dummy>\n";
+  out << "alignas(64) const float " << tn << "<Dummy>::value[" << n+1 
+      << "] = \n  {";
+  for (int i = 0; i <= n; i++)
+    {
+      // Float literal: 0f and 1f are not valid C++
+      ostringstream v; v << setprecision(9) << value[i];
+      string literal(v.str());
+      if ( literal.find_first_of(".e") == string::npos ) literal += ".0";
+      if ( i > 0 ) out << ",";
+      if ( i > 0 && i % 4 == 0 ) out << "\n   ";
+      out << setw(17) << literal + "f";
+    }
+  out << "};\n";
+  out << "\n";
+  out << "template <class T>\n";
+  out << "inline T jntanh" << n << "(T x)\n";
+  out << "{\n";
+  out << "  const float* t = " << tn << "<void>::value;\n";
+  out << "  T u = (x + " << ActivationTable::RANGE << ") * (T)" 
+      << n / (2 * ActivationTable::RANGE) << ";\n";
+  out << "  u = u < 0 ? 0 : (u > " << n << " ? " << n << " : u);\n";
+  out << "  int k = (int)u;\n";
+  out << "  k = k < " << n << " ? k : " << n-1 << ";\n";
+  out << "  return t[k] + (u - k) * (t[k+1] - t[k]);\n";
+  out << "}\n";
+  out << "\n";
+  out << "template <class T>\n";
+  out << "inline T jnsigmoid" << n << "(T x)\n";
+  out << "{\n";
+  out << "  return (T)0.5 * ((T)1 + jntanh" << n << "(x));\n";
+  out << "}\n";
+  out << "#endif\n";
+  out << 
+    "//-------------------------------------------"
+    "----------------------------\n";
+}
+
 // Write out C++ function
 
 int nnsaveCPP(string title1, 
@@ -233,10 +456,21 @@ int nnsaveCPP(string title1,
 	      vector<string>&  var,
 	      vector<float>&   mean,
 	      vector<float>&   sigma,
-	      int outputType)
+	      int outputType,
+	      bool arrays,
+	      int table)
 {
   if ( weight.size() == 0 ) return -1;
 
+  const ActivationTable* tanhtable = 0;
+  if ( table > 0 )
+    {
+      tanhtable = ActivationTable::shared(table);
+      ostringstream n; n << tanhtable->intervals();
+      sigmoid    = "jntanh"    + n.str() + "(x)";
+      sigmoidout = "jnsigmoid" + n.str() + "(x)";
+    }
+
   int ninput  = nodes[0];
   int noutput = nodes[nodes.size()-1];
 
@@ -262,48 +496,56 @@ int nnsaveCPP(string title1,
     "-------------------------------\n";
   out << "#include <cmath>\n";
   out << "#include <vector>\n";
+  if ( arrays ) out << "#include <cstddef>\n";
   out << 
     "//-------------------------------------------"
     "----------------------------\n";
-  out << "inline\n";
-  out << "double sigmoid(double x)\n";
-  out << "{\n";
-  out << "  return " << sigmoid << ";" << endl;
-  out << "}\n";
-  out << "inline\n";
-  out << "double sigmoidout(double x)\n";
-  out << "{\n";
-  out << "  return " << sigmoidout << ";" << endl;
-  out << "}\n";
-  out << "\n";
-  out << "void jn" << name << "(double* in, double* out)\n";
-  out << "{\n";
-  out << "  double x;\n";
-  out << "\n";
-    for (int i = 0; i < ninput; i++)
+  if ( tanhtable ) nnwritetable(out, tanhtable);
+  if ( arrays )
+    nnwritearrays(out, name, sigmoid, sigmoidout, 
+		  nodes, weight, mean, sigma, outputType);
+  else
     {
-      out << "  double x0" << i << " = (in[" << i << "]-" 
-	  << "(" << mean[i] << ")" << ")/" << sigma[i] << ";\n"; 
-    }
+      out << "inline\n";
+      out << "double sigmoid(double x)\n";
+      out << "{\n";
+      out << "  return " << sigmoid << ";" << endl;
+      out << "}\n";
+      out << "inline\n";
+      out << "double sigmoidout(double x)\n";
+      out << "{\n";
+      out << "  return " << sigmoidout << ";" << endl;
+      out << "}\n";
+      out << "\n";
+      out << "void jn" << name << "(double* in, double* out)\n";
+      out << "{\n";
+      out << "  double x;\n";
+      out << "\n";
+      for (int i = 0; i < ninput; i++)
+	{
+	  out << "  double x0" << i << " = (in[" << i << "]-" 
+	      << "(" << mean[i] << ")" << ")/" << sigma[i] << ";\n"; 
+	}
 
-  vector<string> inp(ninput);
-  for (int i = 0; i < ninput; i++)
-    {
-      ostringstream s;
-      s << "x0" << i << "";
-      inp[i] = string(s.str());
-    }
+      vector<string> inp(ninput);
+      for (int i = 0; i < ninput; i++)
+	{
+	  ostringstream s;
+	  s << "x0" << i << "";
+	  inp[i] = string(s.str());
+	}
 
-  ostringstream os;
-  nnwrite(1,0, nodes, weight, inp, os, 1, outputType);
-  out << os.str();
+      ostringstream os;
+      nnwrite(1,0, nodes, weight, inp, os, 1, outputType);
+      out << os.str();
 
-  for (int i = 0; i < noutput; i++)
-    {
-      out << "  out[" << i << "] = x" 
-	  << nodes.size()-1 << i << ";" << endl; 
+      for (int i = 0; i < noutput; i++)
+	{
+	  out << "  out[" << i << "] = x" 
+	      << nodes.size()-1 << i << ";" << endl; 
+	}
+      out << "}\n\n";
     }
-  out << "}\n\n";
 
   // Write out a more convenient interface
 
@@ -362,36 +604,65 @@ int nnsaveCPP(string title1,
   return 0;
 }
 
+// Histogram statistics, for pattern counts (int) and sums of pattern
+// weights (double)
+
+namespace {
+  template <class T>
+  float power(vector<T>& s, vector<T>& b)
+  {
+    float sums = 0.0;
+    float sumb = 0.0;
+    int   nbin = min(s.size(),b.size());
+    if ( nbin < 1 ) return 0;
+
+    for (int i = 0; i < nbin; i++)
+      {
+        sums += s[i];
+        sumb += b[i];
+      }
+
+    float pwr = 0.0;
+    for (int i = 0; i < nbin; i++)
+      pwr += fabs(s[i]/sums - b[i]/sumb);
+
+    return 0.5*pwr;
+  }
+}
+
 float nnpower(vector<int>& s, vector<int>& b)
 {
-  float sums = 0.0;
-  float sumb = 0.0;
-  int   nbin = min(s.size(),b.size());
-  if ( nbin < 1 ) return 0;
-
-  for (int i = 0; i < nbin; i++)
-    {
-      sums += s[i];
-      sumb += b[i];
-    }
+  return power(s, b);
+}
 
-  float pwr = 0.0;
-  for (int i = 0; i < nbin; i++)
-    pwr += fabs(s[i]/sums - b[i]/sumb);
+float nnpower(vector<double>& s, vector<double>& b)
+{
+  return power(s, b);
+}
 
-  return 0.5*pwr;
+namespace {
+  template <class T>
+  void efficiencies(vector<T>& v, vector<float>& e)
+  {
+    int nbin = v.size();
+    vector<float> c(nbin);
+    c[0] = v[0];
+    for(int bin=1; bin < nbin; bin++) c[bin] = c[bin-1] + v[bin];
+    if ( c[nbin-1] > 0 )
+      for(int bin=0; bin < nbin; bin++) e[bin] = 1.0-c[nbin-1-bin]/c[nbin-1];
+    else
+      for(int bin=0; bin < nbin; bin++) e[bin] = (float)bin / nbin;
+  }
 }
 
 void nnefficiencies(vector<int>& v, vector<float>& e)
 {
-  int nbin = v.size();
-  vector<float> c(nbin);
-  c[0] = v[0];
-  for(int bin=1; bin < nbin; bin++) c[bin] = c[bin-1] + v[bin];
-  if ( c[nbin-1] > 0 )
-    for(int bin=0; bin < nbin; bin++) e[bin] = 1.0-c[nbin-1-bin]/c[nbin-1];
-  else
-    for(int bin=0; bin < nbin; bin++) e[bin] = (float)bin / nbin;
+  efficiencies(v, e);
+}
+
+void nnefficiencies(vector<double>& v, vector<float>& e)
+{
+  efficiencies(v, e);
 }
 
 float nnarea(vector<float>& ex, vector<float>& ey)
@@ -422,27 +693,40 @@ float nnarea(vector<float>& ex, vector<float>& ey)
 
 // Compute Kullback-Leibler divergence
 
+namespace {
+  template <class T>
+  float divergence(vector<T>& s, vector<T>& b)
+  {
+    int   nbin = min(s.size(),b.size());
+    if ( nbin < 1 ) return -1;
+
+    float sums = 0.0;
+    float sumb = 0.0;
+    for (int i = 0; i < nbin; i++)
+      {
+        sums += s[i];
+        sumb += b[i];
+      }
+
+    float d = 0.0;
+    for (int i = 0; i < nbin; i++)
+      {
+        float p = (float)s[i] / sums;
+        float q = (float)b[i] / sumb;
+        if ( q > 0 ) d += p*log((p+1.e-30)/q);
+      }
+    return d;
+  }
+}
+
 float nndivergence(vector<int>& s, vector<int>& b)
 {
-  int   nbin = min(s.size(),b.size());
-  if ( nbin < 1 ) return -1;
-
-  float sums = 0.0;
-  float sumb = 0.0;
-  for (int i = 0; i < nbin; i++)
-    {
-      sums += s[i];
-      sumb += b[i];
-    }
+  return divergence(s, b);
+}
 
-  float d = 0.0;
-  for (int i = 0; i < nbin; i++)
-    {
-      float p = (float)s[i] / sums;
-      float q = (float)b[i] / sumb;
-      if ( q > 0 ) d += p*log((p+1.e-30)/q);
-    }
-  return d;
+float nndivergence(vector<double>& s, vector<double>& b)
+{
+  return divergence(s, b);
 }
 
 
@@ -0,0 +1,319 @@
+//-----------------------------------------------------------------------------
+// File: nnkernel.cc
+// Purpose: Native forward kernels used for batched network evaluation
+// Created: 18-Oct-2026
+//-----------------------------------------------------------------------------
+#include <stdlib.h>
+#include <assert.h>
+#include <cmath>
+#include <algorithm>
+
+#include "nnkernel.h"
+#include "ActivationTable.h"
+
+using namespace std;
+
+// Rational approximation of tanh (numerator of degree 13, denominator
+// of degree 6) on [-7.9, 7.9]; outside that range tanh(x) rounds
+// to +/-1 in single precision.
+// Note: the loops below vectorize only when the compiler may assume
+// that floating point comparisons do not trap (-fno-trapping-math,
+// see Makefile).
+
+#if defined(__GNUC__)
+#define NNINLINE inline __attribute__((always_inline))
+#else
+#define NNINLINE inline
+#endif
+
+static NNINLINE float fasttanh(float x)
+{
+  const float clamp = 7.90531110763549805f;
+
+  const float a1  = 4.89352455891786e-03f;
+  const float a3  = 6.37261928875436e-04f;
+  const float a5  = 1.48572235717979e-05f;
+  const float a7  = 5.12229709037114e-08f;
+  const float a9  =-8.60467152213735e-11f;
+  const float a11 = 2.00018790482477e-13f;
+  const float a13 =-2.76076847742355e-16f;
+
+  const float b0  = 4.89352518554385e-03f;
+  const float b2  = 2.26843463243900e-03f;
+  const float b4  = 1.18534705686654e-04f;
+  const float b6  = 1.19825839466702e-06f;
+
+  float z  = x < -clamp ? -clamp : (x > clamp ? clamp : x);
+  float z2 = z * z;
+
+  float p = z2 * a13 + a11;
+  p = z2 * p + a9;
+  p = z2 * p + a7;
+  p = z2 * p + a5;
+  p = z2 * p + a3;
+  p = z2 * p + a1;
+  p = z  * p;
+
+  float q = z2 * b6 + b4;
+  q = z2 * q + b2;
+  q = z2 * q + b0;
+
+  return p / q;
+}
+
+float nntanh(float x)
+{
+  return fasttanh(x);
+}
+
+// Loops over the values, compiled once per instruction set below
+
+static NNINLINE void activate(int type, float* __restrict__ x, int n)
+{
+  switch ( type )
+    {
+    case 1:
+    case 5:
+      // Same form as GJN: g(x) = (1+tanh(x))/2
+      for (int i = 0; i < n; i++) x[i] = 0.5f * (1.0f + fasttanh(x[i]));
+      break;
+    case 2:
+      for (int i = 0; i < n; i++) x[i] = fasttanh(x[i]);
+      break;
+    case 4:
+      break;
+    default:
+      assert(!"nnactivate: unknown transfer function");
+      break;
+    }
+}
+
+static NNINLINE void activate(int type, 
+			      float* __restrict__ x, 
+			      float* __restrict__ dx, 
+			      int n)
+{
+  switch ( type )
+    {
+    case 1:
+      for (int i = 0; i < n; i++) 
+	{
+	  float t = fasttanh(x[i]);
+	  x[i]  = 0.5f * (1.0f + t);
+	  dx[i] = 0.5f * (1.0f - t * t);
+	}
+      break;
+    case 2:
+      for (int i = 0; i < n; i++) 
+	{
+	  float t = fasttanh(x[i]);
+	  x[i]  = t;
+	  dx[i] = 1.0f - t * t;
+	}
+      break;
+    case 5:
+      for (int i = 0; i < n; i++) 
+	{
+	  x[i]  = 0.5f * (1.0f + fasttanh(x[i]));
+	  dx[i] = 2.0f;
+	}
+      break;
+    case 4:
+      for (int i = 0; i < n; i++) dx[i] = 1.0f;
+      break;
+    default:
+      assert(!"nnactivate: unknown transfer function");
+      break;
+    }
+}
+
+// Tanh interpolated in a table of intervals+1 values on [-8, 8]. The
+// two loads per value become gathers with AVX2 and AVX-512. (The table
+// is not declared __restrict__: with it, GCC does not emit the gathers.)
+
+static NNINLINE float lookup(const float* table, 
+			     int intervals, float x)
+{
+  float top = (float)intervals;
+  float u = (x + 8.0f) * (top * 0.0625f);
+  u = u < 0.0f ? 0.0f : (u > top ? top : u);
+  int k = (int)u;
+  k = k < intervals ? k : intervals - 1;
+  float a = table[k];
+  float b = table[k+1];
+  return a + (u - (float)k) * (b - a);
+}
+
+static NNINLINE void interpolate(int type, const float* table,
+				 int intervals, float* __restrict__ x, int n)
+{
+  switch ( type )
+    {
+    case 1:
+    case 5:
+      for (int i = 0; i < n; i++) 
+	x[i] = 0.5f * (1.0f + lookup(table, intervals, x[i]));
+      break;
+    case 2:
+      for (int i = 0; i < n; i++) x[i] = lookup(table, intervals, x[i]);
+      break;
+    case 4:
+      break;
+    default:
+      assert(!"nnactivate: unknown transfer function");
+      break;
+    }
+}
+
+namespace {
+  typedef void (*Activate) (int, float*, int);
+  typedef void (*ActivateD)(int, float*, float*, int);
+  typedef void (*Interpolate)(int, const float*, int, float*, int);
+
+  struct Kernels
+  {
+    const char* isa;
+    Activate    activate;
+    ActivateD   activated;
+    Interpolate interpolate;
+  };
+
+  void activate_generic(int type, float* x, int n) 
+  { activate(type, x, n); }
+
+  void activated_generic(int type, float* x, float* dx, int n)
+  { activate(type, x, dx, n); }
+
+  void interpolate_generic(int type, const float* t, int m, float* x, int n)
+  { interpolate(type, t, m, x, n); }
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define NNDISPATCH
+
+  __attribute__((target("avx2")))
+  void activate_avx2(int type, float* x, int n) 
+  { activate(type, x, n); }
+
+  __attribute__((target("avx2")))
+  void activated_avx2(int type, float* x, float* dx, int n)
+  { activate(type, x, dx, n); }
+
+  __attribute__((target("avx2")))
+  void interpolate_avx2(int type, const float* t, int m, float* x, int n)
+  { interpolate(type, t, m, x, n); }
+
+  __attribute__((target("avx512f")))
+  void activate_avx512(int type, float* x, int n) 
+  { activate(type, x, n); }
+
+  __attribute__((target("avx512f")))
+  void activated_avx512(int type, float* x, float* dx, int n)
+  { activate(type, x, dx, n); }
+
+  __attribute__((target("avx512f")))
+  void interpolate_avx512(int type, const float* t, int m, float* x, int n)
+  { interpolate(type, t, m, x, n); }
+#endif
+
+  // Select the widest instruction set supported by the processor
+
+  Kernels select()
+  {
+    Kernels k = {"generic", activate_generic, activated_generic,
+		 interpolate_generic};
+#ifdef NNDISPATCH
+    __builtin_cpu_init();
+    if ( getenv("JETNET_NOSIMD") != 0 ) return k;
+    if ( __builtin_cpu_supports("avx512f") )
+      {
+	k.isa = "avx512f";
+	k.activate  = activate_avx512;
+	k.activated = activated_avx512;
+	k.interpolate = interpolate_avx512;
+      }
+    else if ( __builtin_cpu_supports("avx2") )
+      {
+	k.isa = "avx2";
+	k.activate  = activate_avx2;
+	k.activated = activated_avx2;
+	k.interpolate = interpolate_avx2;
+      }
+#endif
+    return k;
+  }
+
+  const Kernels& kernels()
+  {
+    static const Kernels k = select();
+    return k;
+  }
+};
+
+const char* nnisa()
+{
+  return kernels().isa;
+}
+
+void nnactivate(int type, float* x, int n)
+{
+  kernels().activate(type, x, n);
+}
+
+void nnactivate(int type, float* x, float* dx, int n)
+{
+  kernels().activated(type, x, dx, n);
+}
+
+void nnactivate(int type, const float* table, int intervals, float* x, int n)
+{
+  kernels().interpolate(type, table, intervals, x, n);
+}
+
+void nnlayer(int nin, int nout, 
+	     const float* __restrict__ w, 
+	     const float* __restrict__ y, 
+	     float* __restrict__ x)
+{
+  int k = 0;
+  for (int i = 0; i < nout; i++)
+    {
+      float* __restrict__ xi = x + i * NNBLOCK;
+      float  t  = w[k++];
+      for (int b = 0; b < NNBLOCK; b++) xi[b] = t;
+
+      // Same summation order as JNFEED: threshold first, then inputs
+      for (int j = 0; j < nin; j++)
+	{
+	  float wij = w[k++];
+	  const float* __restrict__ yj = y + j * NNBLOCK;
+	  for (int b = 0; b < NNBLOCK; b++) xi[b] += wij * yj[b];
+	}
+    }
+}
+
+float* nnforward(const vector<int>&   nodes,
+		 const vector<float>& weight,
+		 const vector<int>&   types,
+		 const float* inp,
+		 float* work,
+		 const ActivationTable* table)
+{
+  int maxnodes = *max_element(nodes.begin(), nodes.end());
+  float* buf[2] = {work, work + maxnodes * NNBLOCK};
+
+  const float* y = inp;
+  float* x = buf[0];
+  int k = 0;
+  for (int l = 1; l < (int)nodes.size(); l++)
+    {
+      x = buf[(l-1) % 2];
+      nnlayer(nodes[l-1], nodes[l], &weight[k], y, x);
+      if ( table )
+	table->apply(types[l-1], x, nodes[l] * NNBLOCK);
+      else
+	nnactivate(types[l-1], x, nodes[l] * NNBLOCK);
+      k += nodes[l] * (nodes[l-1] + 1);
+      y = x;
+    }
+  return x;
+}